@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdint.h>
+
+// Generated by text_tools/build_bigrams.py from text_tools/corpus/letters.txt, do not edit by hand
+namespace Bigrams {
+	struct Successor {
+		const char* glyph;
+		uint8_t weight;
+	};
+
+	struct Row {
+		const char* glyph;
+		Successor next[4];
+	};
+
+	inline constexpr Row rows[] = {
+		{"␣", {{"t", 37}, {"a", 26}, {"w", 16}, {"s", 15}}},
+		{"e", {{"␣", 99}, {"r", 26}, {"a", 18}, {"n", 12}}},
+		{"t", {{"␣", 79}, {"h", 70}, {"o", 31}, {"e", 20}}},
+		{"o", {{"u", 53}, {"␣", 33}, {"n", 26}, {"r", 26}}},
+		{"a", {{"n", 53}, {"r", 29}, {"␣", 29}, {"t", 24}}},
+		{"n", {{"d", 48}, {"␣", 45}, {"e", 33}, {"g", 32}}},
+		{"i", {{"n", 71}, {"t", 44}, {"s", 30}, {"l", 21}}},
+		{"h", {{"e", 111}, {"a", 35}, {"i", 31}, {"o", 31}}},
+		{"r", {{"␣", 72}, {"e", 44}, {"i", 31}, {"o", 18}}},
+		{"s", {{"␣", 73}, {"e", 36}, {"t", 35}, {"o", 26}}},
+		{"l", {{"l", 50}, {"e", 45}, {"␣", 39}, {"o", 27}}},
+		{"y", {{"␣", 112}, {"o", 88}, {"e", 17}, {".", 12}}},
+		{"u", {{"␣", 62}, {"r", 45}, {"s", 29}, {"t", 24}}},
+		{"d", {{"␣", 143}, {"a", 28}, {".", 16}, {"e", 15}}},
+		{"w", {{"a", 48}, {"i", 46}, {"␣", 42}, {"e", 38}}},
+		{"m", {{"e", 80}, {"y", 38}, {"␣", 31}, {"o", 25}}},
+		{".", {{"␣", 190}, {"↵", 62}, {"K", 2}, {",", 2}}},
+		{"g", {{"␣", 99}, {"h", 42}, {"e", 30}, {"o", 25}}},
+		{"f", {{"o", 73}, {"i", 41}, {"␣", 39}, {"r", 24}}},
+		{"p", {{"l", 44}, {"␣", 39}, {"e", 37}, {"r", 33}}},
+		{"I", {{"␣", 207}, {"t", 30}, {"f", 7}, {"s", 5}}},
+		{"b", {{"e", 63}, {"o", 39}, {"y", 39}, {"u", 26}}},
+		{"c", {{"a", 58}, {"o", 49}, {"h", 44}, {"e", 30}}},
+		{"↵", {{"T", 47}, {"I", 37}, {"H", 37}, {"D", 34}}},
+		{"k", {{"␣", 112}, {"e", 66}, {"i", 23}, {"s", 20}}},
+		{",", {{"␣", 176}, {"↵", 79}}},
+		{"v", {{"e", 229}, {"o", 13}, {"i", 9}, {"y", 4}}},
+		{"T", {{"h", 194}, {"o", 44}, {"a", 6}, {"u", 6}}},
+		{"!", {{"␣", 134}, {"↵", 121}}},
+		{"D", {{"e", 195}, {"o", 60}}},
+		{"H", {{"i", 90}, {"e", 90}, {"a", 30}, {"u", 30}}},
+		{"x", {{"t", 204}, {"␣", 17}, {"↵", 17}, {",", 17}}},
+		{"M", {{"a", 85}, {"i", 51}, {"y", 51}, {"e", 34}}},
+		{"A", {{"p", 153}, {"r", 17}, {"n", 17}, {"␣", 17}}},
+		{"S", {{"a", 91}, {"e", 36}, {"o", 36}, {"u", 36}}},
+		{"B", {{"e", 98}, {"r", 59}, {"o", 39}, {"l", 39}}},
+		{"?", {{"␣", 234}, {"↵", 21}}},
+		{"P", {{"l", 162}, {"r", 46}, {"i", 23}, {"e", 23}}},
+		{"W", {{"e", 162}, {"h", 46}, {"a", 23}, {"i", 23}}},
+		{"N", {{"o", 102}, {"e", 102}, {"i", 51}}},
+		{"'", {{"t", 178}, {"s", 51}, {"n", 26}}},
+		{"L", {{"e", 113}, {"o", 85}, {"a", 28}, {"i", 28}}},
+		{"C", {{"o", 191}, {"h", 32}, {"e", 32}}},
+		{"Y", {{"o", 219}, {"e", 36}}},
+		{"R", {{"e", 128}, {"o", 85}, {"u", 42}}},
+		{"z", {{"a", 170}, {"e", 85}}},
+		{"K", {{"a", 85}, {".", 85}, {"i", 85}}},
+		{"j", {{"u", 191}, {"a", 64}}},
+		{"G", {{"r", 128}, {"o", 128}}},
+		{"F", {{"o", 128}, {"i", 128}}},
+		{"E", {{"l", 170}, {"v", 85}}},
+		{":", {{"␣", 255}}},
+		{"J", {{"u", 255}}},
+		{"O", {{"t", 255}}},
+		{"Z", {{"o", 255}}},
+		{"3", {{"↵", 255}}},
+		{"4", {{"↵", 255}}},
+		{"5", {{"↵", 255}}},
+		{"6", {{"↵", 255}}},
+		{"7", {{"↵", 255}}},
+		{"q", {{"u", 255}}},
+		{"8", {{"↵", 255}}},
+		{"9", {{"↵", 255}}},
+		{"1", {{"0", 255}}},
+		{"0", {{"↵", 255}}},
+	};
+}
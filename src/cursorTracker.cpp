@@ -0,0 +1,230 @@
+#include "cursorTracker.hpp"
+#include "glyphIndex.hpp"
+#include "joybus.hpp"
+#include "predictor.hpp"
+#include <climits>
+
+extern VirtualKeyboardPos currentPos;
+extern SimulatedState simulatedState;
+
+static const uint8_t LAST_ROW = GlyphIndex::ROWS - 1;
+static const uint8_t LAST_COL = GlyphIndex::COLS - 1;
+
+// While exact, currentPos is the truth and the ranges are refreshed from it before use
+static bool exact = false;
+static bool layerKnown = false;
+static CursorTracker::Range rows = {0, LAST_ROW};
+static CursorTracker::Range cols = {0, LAST_COL};
+
+// One stick or D-pad axis as seen across polls
+struct AxisState {
+	int8_t direction;   // -1, 0 or +1
+	bool registered;    // Deflected far enough that the game surely saw the tap
+	bool repeating;     // Held past the auto repeat delay, the axis has been given up on
+	uint32_t sincePoll;
+};
+
+static AxisState stickX = {};
+static AxisState stickY = {};
+static AxisState dpadX = {};
+static AxisState dpadY = {};
+
+static void syncFromCursor() {
+	if (exact) {
+		rows = {currentPos.row, currentPos.row};
+		cols = {currentPos.col, currentPos.col};
+	}
+}
+
+static void syncToCursor() {
+	exact = layerKnown && rows.min == rows.max && cols.min == cols.max;
+	if (exact) {
+		currentPos.row = rows.min;
+		currentPos.col = cols.min;
+	}
+	simulatedState.keyboard_calibrated = exact;
+}
+
+static uint8_t clampStep(uint8_t value, int step, uint8_t last) {
+	int result = value + step;
+	if (result < 0) return 0;
+	if (result > last) return last;
+	return result;
+}
+
+static CursorTracker::Range shifted(CursorTracker::Range range, int step, uint8_t last) {
+	return {clampStep(range.min, step, last), clampStep(range.max, step, last)};
+}
+
+static CursorTracker::Range merged(CursorTracker::Range a, CursorTracker::Range b) {
+	return {a.min < b.min ? a.min : b.min, a.max > b.max ? a.max : b.max};
+}
+
+// A tap the game registered for sure moves every possible position, one it may have missed widens the range
+static void applyTap(bool horizontal, int step, bool sure) {
+	syncFromCursor();
+	CursorTracker::Range& range = horizontal ? cols : rows;
+	uint8_t last = horizontal ? LAST_COL : LAST_ROW;
+	CursorTracker::Range moved = shifted(range, step, last);
+	range = sure ? moved : merged(range, moved);
+	syncToCursor();
+}
+
+static void forgetAxis(bool horizontal) {
+	syncFromCursor();
+	if (horizontal) {
+		cols = {0, LAST_COL};
+	} else {
+		rows = {0, LAST_ROW};
+	}
+	syncToCursor();
+}
+
+// `step` is the cursor step the deflection maps to, `sure` whether it is past the game's threshold for certain
+static void trackAxis(AxisState& axis, bool horizontal, int step, bool sure, uint32_t poll) {
+	if (step != axis.direction) {
+		// Released or flipped before reaching a sure deflection: the game may or may not have moved
+		if (axis.direction != 0 && !axis.registered) {
+			applyTap(horizontal, axis.direction, false);
+		}
+		axis = {(int8_t)step, false, false, poll};
+	}
+	if (step == 0) return;
+
+	if (sure && !axis.registered) {
+		axis.registered = true;
+		applyTap(horizontal, step, true);
+	}
+	uint32_t repeatDelay = CursorTracker::REPEAT_DELAY_FRAMES * simulatedState.timing.pollsPerFrame;
+	if (axis.registered && !axis.repeating && poll - axis.sincePoll >= repeatDelay) {
+		axis.repeating = true;
+		forgetAxis(horizontal);
+	}
+}
+
+static void trackStick(AxisState& axis, bool horizontal, int deflection, uint32_t poll) {
+	int magnitude = deflection < 0 ? -deflection : deflection;
+	int step = 0;
+	if (magnitude > CursorTracker::STICK_DEADZONE) {
+		step = deflection < 0 ? -1 : 1;
+	}
+	trackAxis(axis, horizontal, step, magnitude >= CursorTracker::STICK_SURE_THRESHOLD, poll);
+}
+
+namespace CursorTracker {
+
+	void lose() {
+		exact = false;
+		layerKnown = false;
+		rows = {0, LAST_ROW};
+		cols = {0, LAST_COL};
+		simulatedState.keyboard_calibrated = false;
+		Predictor::reset();
+	}
+
+	void mayStillBeAt(const VirtualKeyboardPos& pos) {
+		syncFromCursor();
+		rows = merged(rows, {pos.row, pos.row});
+		cols = merged(cols, {pos.col, pos.col});
+		syncToCursor();
+	}
+
+	bool isExact() {
+		return exact;
+	}
+
+	Range getRows() {
+		syncFromCursor();
+		return rows;
+	}
+
+	Range getCols() {
+		syncFromCursor();
+		return cols;
+	}
+
+	void trackPassthrough(uint8_t dpadState, uint8_t analogX, uint8_t analogY, bool startPressed) {
+		if (startPressed) {
+			lose();
+			return;
+		}
+		uint32_t poll = getPollCount();
+
+		// Stick up (255) and D-pad up move to a lower row
+		trackStick(stickX, true, analogX - 128, poll);
+		trackStick(stickY, false, 128 - analogY, poll);
+
+		int dpadStepX = (dpadState & 0x02) ? 1 : (dpadState & 0x01) ? -1 : 0;
+		int dpadStepY = (dpadState & 0x04) ? 1 : (dpadState & 0x08) ? -1 : 0;
+		trackAxis(dpadX, true, dpadStepX, true, poll);
+		trackAxis(dpadY, false, dpadStepY, true, poll);
+	}
+
+	Reanchor planReanchor(GlyphId next) {
+		syncFromCursor();
+		uint8_t layer = layerKnown ? currentPos.layer : 0;
+		const GlyphIndex::Glyph* entry = GlyphIndex::find(next);
+
+		// Known axes stay put, unknown ones go to either edge
+		uint8_t colEnds[2] = {cols.min, cols.min};
+		uint8_t rowEnds[2] = {rows.min, rows.min};
+		if (cols.min != cols.max) {
+			colEnds[0] = 0;
+			colEnds[1] = LAST_COL;
+		}
+		if (rows.min != rows.max) {
+			rowEnds[0] = 0;
+			rowEnds[1] = LAST_ROW;
+		}
+
+		Reanchor best = {};
+		int bestCost = INT_MAX;
+		for (uint8_t endCol : colEnds) {
+			for (uint8_t endRow : rowEnds) {
+				Reanchor candidate = {};
+				candidate.endCol = endCol;
+				candidate.endRow = endRow;
+				if (cols.min != cols.max) {
+					candidate.colStep = endCol == 0 ? -1 : 1;
+					candidate.colTaps = endCol == 0 ? cols.max : LAST_COL - cols.min;
+				}
+				if (rows.min != rows.max) {
+					candidate.rowStep = endRow == 0 ? -1 : 1;
+					candidate.rowTaps = endRow == 0 ? rows.max : LAST_ROW - rows.min;
+				}
+
+				// Each tap is one input, same direction taps also need a neutral in between
+				int paired = candidate.colTaps < candidate.rowTaps ? candidate.colTaps : candidate.rowTaps;
+				int single = candidate.colTaps + candidate.rowTaps - 2 * paired;
+				int cost = 2 * paired + (single > 0 ? 2 * single - 1 : 0);
+
+				if (entry != nullptr) {
+					int reach = INT_MAX;
+					uint8_t from = GlyphIndex::cellIndex(layer, endRow, endCol);
+					for (uint8_t i = 0; i < entry->count; i++) {
+						int moves = GlyphIndex::moveCost(from, entry->cells[i]);
+						if (moves < reach) reach = moves;
+					}
+					cost += reach;
+				}
+
+				if (cost < bestCost) {
+					bestCost = cost;
+					best = candidate;
+				}
+			}
+		}
+		return best;
+	}
+
+	void completeReanchor(const Reanchor& reanchor) {
+		if (!layerKnown) {
+			// The keyboard opens on the lowercase layer
+			currentPos.layer = 0;
+			layerKnown = true;
+		}
+		rows = {reanchor.endRow, reanchor.endRow};
+		cols = {reanchor.endCol, reanchor.endCol};
+		syncToCursor();
+	}
+}
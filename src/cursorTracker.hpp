@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include "types.hpp"
+
+// Follows the in-game keyboard cursor through passthrough input, so typing only has to
+// re-anchor the axes it actually lost track of instead of running the full calibration.
+namespace CursorTracker {
+	// Stick deflection the game surely reads as a tap; between the deadzone and this it may or may not
+	static const int STICK_SURE_THRESHOLD = 64;
+	static const int STICK_DEADZONE = 30;
+
+	// Frames a direction may be held before the game's auto repeat could have moved the cursor again
+	static const uint32_t REPEAT_DELAY_FRAMES = 20;
+
+	// Inclusive range of rows or columns the cursor may be on
+	struct Range {
+		uint8_t min;
+		uint8_t max;
+	};
+
+	// Nothing is known any more, e.g. Start closed the keyboard. The predictor forgets its context too
+	void lose();
+
+	// The cursor may also still be at `pos`'s row and column, e.g. a tap was cut short before the game read it
+	void mayStillBeAt(const VirtualKeyboardPos& pos);
+
+	// Whether currentPos is exactly where the in-game cursor is
+	bool isExact();
+	Range getRows();
+	Range getCols();
+
+	// Mirrors D-pad (including arrow keys), stick and Start from passthrough input, once per report
+	void trackPassthrough(uint8_t dpadState, uint8_t analogX, uint8_t analogY, bool startPressed);
+
+	// Taps into an edge per axis (step -1 or +1) and where the cursor ends up after them
+	struct Reanchor {
+		int8_t colStep;
+		uint8_t colTaps;
+		int8_t rowStep;
+		uint8_t rowTaps;
+		uint8_t endRow;
+		uint8_t endCol;
+	};
+
+	// Cheapest re-anchor for typing `next` afterwards: each unknown axis is pushed into
+	// whichever edge is cheaper, known axes are left alone
+	Reanchor planReanchor(GlyphId next);
+
+	// Called once the planned taps have been played, sets currentPos to where they ended
+	void completeReanchor(const Reanchor& reanchor);
+}
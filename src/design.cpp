@@ -2,15 +2,15 @@
 #include "simulatedController.hpp"
 #include "types.hpp"
 #include "gcReport.hpp"
+#include "joybus.hpp"
+#include "glyphIndex.hpp"
+#include "patternPlanner.hpp"
 #include <cstdio>
 #include <cstring>
 #include <pico/stdlib.h>
 
-bool isPaintCharacter(const Utf8Char& c) {
-	// Compare with UTF-8 bytes for 🎨
-	static const uint8_t paintChar[] = {0xF0, 0x9F, 0x8E, 0xA8};
-	if (c.length != 4) return false;
-	return memcmp(c.bytes, paintChar, 4) == 0;
+bool isPaintCharacter(GlyphId c) {
+	return c == GlyphIndex::PAINT;
 }
 
 // External declarations
@@ -25,6 +25,30 @@ static Design::DesignState designState = Design::DesignState::INIT_CALIBRATE;
 static Design::Frameset currentFrameset;
 static bool designSequenceStarted = false;
 
+// Polls the given state holds its input (or its neutral) for
+static uint32_t requiredPolls(Design::DesignState state, const InputTiming& timing) {
+	switch (state) {
+		case Design::DesignState::MOVE_TO_PALETTE_MENU:
+		case Design::DesignState::CHANGE_PALETTE_BUTTON:
+		case Design::DesignState::RETURN_TO_CANVAS:
+		case Design::DesignState::EXIT_DESIGN:
+			return timing.buttonPolls;
+		case Design::DesignState::CALIBRATE_NEUTRAL:
+		case Design::DesignState::PALETTE_MENU_NEUTRAL:
+		case Design::DesignState::PALETTE_NAV_NEUTRAL:
+		case Design::DesignState::PALETTE_BUTTON_NEUTRAL:
+		case Design::DesignState::RETURN_CANVAS_NEUTRAL:
+		case Design::DesignState::SELECT_COLOR_NEUTRAL:
+		case Design::DesignState::DRAW_PIXEL_NEUTRAL:
+		case Design::DesignState::MOVE_CURSOR_NEUTRAL:
+		case Design::DesignState::TOOL_MENU_NEUTRAL:
+		case Design::DesignState::EXIT_NEUTRAL:
+			return timing.releasePolls;
+		default:
+			return timing.holdPolls;
+	}
+}
+
 // Current position tracking
 int design_currentX = 0;         // Made non-static to be accessible from other files
 int design_currentY = 0;         // Made non-static to be accessible from other files
@@ -37,7 +61,145 @@ static int calibrationStep = 0;   // Used for initial cursor positioning
 static int targetX = 0;
 static int targetY = 0;
 static uint8_t targetColor = 0;
-static bool movingRight = true;   // Direction for "snaking" path, true = right, false = left
+
+// Drawing order for the current frame, planned once its loading has settled
+static PatternPlanner::Plan framePlan;
+static uint16_t planIndex = 0;
+static bool fillPending = false;   // The canvas gets filled with targetColor before the first step
+static PatternPlanner::Tool currentTool = PatternPlanner::Tool::PEN;
+
+// What the pattern shows once a frame is finished, so the next frame only draws what changed.
+// Unknown until design mode has drawn a whole frame itself
+static Design::FrameData canvasModel;
+static bool canvasKnown = false;
+
+static Design::RecalibrationPolicy recalibrationPolicy = Design::RecalibrationPolicy::AFTER_USER_INPUT;
+static uint32_t framesSinceCalibration = 0;
+static bool userInputSeen = false;   // Since the cursor was last calibrated
+
+// Tool menu inputs. The menu opens on the tool in use: the pen at the top left, the bucket below it
+enum class MenuInput { L, UP, DOWN, LEFT, RIGHT, A };
+
+// Fills the whole canvas and picks the pen again, same as Snake::blanketFillWithColor
+static const MenuInput fillSequence[] = {
+	MenuInput::L, MenuInput::DOWN,
+	MenuInput::RIGHT, MenuInput::RIGHT, MenuInput::RIGHT, MenuInput::RIGHT, MenuInput::RIGHT,
+	MenuInput::A, MenuInput::A,
+	MenuInput::L,
+	MenuInput::LEFT, MenuInput::LEFT, MenuInput::LEFT, MenuInput::LEFT, MenuInput::LEFT,
+	MenuInput::UP, MenuInput::A
+};
+static const MenuInput bucketSequence[] = {MenuInput::L, MenuInput::DOWN, MenuInput::A};
+static const MenuInput penSequence[] = {MenuInput::L, MenuInput::UP, MenuInput::A};
+
+static const MenuInput* menuSequence = nullptr;
+static uint8_t menuLength = 0;
+static uint8_t menuStep = 0;
+
+template <size_t N>
+static Design::DesignState startMenu(const MenuInput (&sequence)[N]) {
+	menuSequence = sequence;
+	menuLength = N;
+	menuStep = 0;
+	return Design::DesignState::TOOL_MENU;
+}
+
+static void loadPlanStep() {
+	const PatternPlanner::Step& step = framePlan.steps[planIndex];
+	targetX = step.x;
+	targetY = step.y;
+	targetColor = step.color;
+}
+
+static void planFrame(const InputTiming& timing) {
+	const Design::FrameData& frame = Design::getCurrentFrame();
+	// Planning blocks core0 while core1 keeps answering polls with the neutral report, so the
+	// polls it takes count towards the settle wait
+	uint32_t planStart = time_us_32();
+	uint32_t planStartPoll = getPollCount();
+	PatternPlanner::plan(frame, canvasKnown ? &canvasModel : nullptr, design_currentX, design_currentY, currentColor,
+						 timing, framePlan);
+	uint32_t planUs = time_us_32() - planStart;
+	uint32_t planPolls = getPollCount() - planStartPoll;
+	planIndex = 0;
+	fillPending = framePlan.fillColor != 0;
+	if (fillPending) {
+		targetColor = framePlan.fillColor;
+	} else if (framePlan.count > 0) {
+		loadPlanStep();
+	}
+	// Part of the way through the plan the canvas is neither frame
+	canvasKnown = false;
+
+	// Reported before drawing starts, so a slow frame can be told apart from a stuck one
+	const PatternPlanner::Cost& cost = framePlan.cost;
+	PatternPlanner::Cost serpentine = PatternPlanner::serpentineCost(frame, currentColor);
+	PatternPlanner::Weights weights = PatternPlanner::weightsFor(timing);
+	printf("Frame %u: %lu inputs, %lu polls planned (%lu moves, %lu color steps, %lu presses, %lu menu buttons), "
+		   "%lu inputs, %lu polls row by row\n",
+		   (unsigned)Design::getCurrentFrameset().currentFrameIndex, (unsigned long)cost.total(),
+		   (unsigned long)cost.polls(weights), (unsigned long)cost.moves, (unsigned long)cost.colorSteps,
+		   (unsigned long)cost.presses, (unsigned long)cost.menuButtons, (unsigned long)serpentine.total(),
+		   (unsigned long)serpentine.polls(weights));
+	if (fillPending) {
+		printf("Filling with color %u first, then %u regions with the bucket\n",
+			   (unsigned)framePlan.fillColor, (unsigned)framePlan.regions);
+	} else {
+		printf("%u pixels changed\n", (unsigned)framePlan.changed);
+	}
+	printf("Planned in %lu us, %lu of %lu settle polls\n", (unsigned long)planUs, (unsigned long)planPolls,
+		   (unsigned long)timing.settlePolls);
+}
+
+static bool atTarget() {
+	return design_currentX == targetX && design_currentY == targetY;
+}
+
+// Once on the target color: fill the canvas, pick the step's tool, or go to the pixel and draw it
+static Design::DesignState afterColorSelected() {
+	if (fillPending) return startMenu(fillSequence);
+	PatternPlanner::Tool tool = framePlan.steps[planIndex].getTool();
+	if (tool != currentTool) {
+		return tool == PatternPlanner::Tool::BUCKET ? startMenu(bucketSequence) : startMenu(penSequence);
+	}
+	return atTarget() ? Design::DesignState::DRAW_PIXEL : Design::DesignState::MOVE_CURSOR;
+}
+
+// The next step of the plan, or on to the next frame once the plan is done and the pen is back
+static Design::DesignState nextPlanStep() {
+	if (planIndex >= framePlan.count) {
+		if (currentTool != PatternPlanner::Tool::PEN) return startMenu(penSequence);
+		canvasModel = Design::getCurrentFrame();
+		canvasKnown = true;
+		// Check if there's another frame to process
+		if (currentFrameset.currentFrameIndex + 1 < Design::getFrameCount()) {
+			return Design::DesignState::NEXT_FRAME;
+		}
+		// Frameset complete, exit design mode
+		return Design::DesignState::EXIT_DESIGN;
+	}
+	// Colors only change between passes of the plan
+	loadPlanStep();
+	return Design::DesignState::SELECT_COLOR;
+}
+
+// Whether the cursor goes back into the corner before the next frame instead of trusting design_currentX/Y
+static bool shouldRecalibrate() {
+	switch (recalibrationPolicy) {
+		case Design::RecalibrationPolicy::EVERY_N_FRAMES:
+			return framesSinceCalibration >= Design::RECALIBRATE_EVERY_FRAMES;
+		case Design::RecalibrationPolicy::AFTER_USER_INPUT:
+			return userInputSeen;
+		default:
+			return false;
+	}
+}
+
+// A frame with nothing to draw over the canvas goes straight on to the next one
+static Design::DesignState startDrawing() {
+	if (fillPending || framePlan.count > 0) return Design::DesignState::SELECT_COLOR;
+	return nextPlanStep();
+}
 
 namespace Design {
 
@@ -45,6 +207,34 @@ namespace Design {
 		return inDesignMode;
 	}
 
+	void setRecalibrationPolicy(RecalibrationPolicy policy) {
+		recalibrationPolicy = policy;
+	}
+
+	RecalibrationPolicy getRecalibrationPolicy() {
+		return recalibrationPolicy;
+	}
+
+	const char* getRecalibrationPolicyName() {
+		switch (recalibrationPolicy) {
+			case RecalibrationPolicy::NEVER: return "never";
+			case RecalibrationPolicy::EVERY_N_FRAMES: return "every few frames";
+			default: return "after controller input";
+		}
+	}
+
+	void nextRecalibrationPolicy() {
+		switch (recalibrationPolicy) {
+			case RecalibrationPolicy::NEVER: recalibrationPolicy = RecalibrationPolicy::EVERY_N_FRAMES; break;
+			case RecalibrationPolicy::EVERY_N_FRAMES: recalibrationPolicy = RecalibrationPolicy::AFTER_USER_INPUT; break;
+			default: recalibrationPolicy = RecalibrationPolicy::NEVER; break;
+		}
+	}
+
+	void noteUserInput() {
+		userInputSeen = true;
+	}
+
 	void enterDesignMode() {
 		inDesignMode = true;
 		designSequenceStarted = false;
@@ -55,10 +245,14 @@ namespace Design {
 		currentPalette = 0;
 		currentColor = 1;  // Start at position 1 (first color in the palette menu)
 		lastColor = 1;     // Initialize last color
-		movingRight = true; // Start with right motion in snaking pattern
 		targetX = 0;
 		targetY = 0;
 		targetColor = 0;
+		fillPending = false;
+		currentTool = PatternPlanner::Tool::PEN;
+		canvasKnown = false;
+		framesSinceCalibration = 0;
+		userInputSeen = false;
 		if (currentFrameset.frames.empty()) {
 			initFrameset();
 		}
@@ -66,21 +260,21 @@ namespace Design {
 		keyBuffer.clear();
 	}
 
-	void processDesign(GCReport& report, uint64_t hold_duration_us) {
-		static absolute_time_t stateStartTime = get_absolute_time();
-		absolute_time_t currentTime = get_absolute_time();
-		int64_t elapsed_us = absolute_time_diff_us(stateStartTime, currentTime);
+	void processDesign(GCReport& report, const InputTiming& timing) {
+		static uint32_t stateStartPoll = getPollCount();
+		uint32_t currentPoll = getPollCount();
+		uint32_t elapsedPolls = currentPoll - stateStartPoll;
 		
 		// Start with neutral controller state by default
 		report = defaultGcReport;
 		
 		// Check for state change based on timing
-		bool stateWillChange = elapsed_us >= hold_duration_us;
+		bool stateWillChange = elapsedPolls >= requiredPolls(designState, timing);
 		
 		// Initialize state machine when first entering design mode
 		if (!designSequenceStarted) {
 			designSequenceStarted = true;
-			stateStartTime = currentTime;
+			stateStartPoll = currentPoll;
 			return;
 		}
 		
@@ -94,7 +288,7 @@ namespace Design {
 				if (stateWillChange) {
 					calibrationStep++;
 					designState = DesignState::CALIBRATE_NEUTRAL;
-					stateStartTime = currentTime;
+					stateStartPoll = currentPoll;
 				}
 				break;
 				
@@ -107,6 +301,8 @@ namespace Design {
 						design_currentX = 0;
 						design_currentY = 0;
 						calibrationStep = 0;
+						framesSinceCalibration = 0;
+						userInputSeen = false;
 						
 						// Transition to settling state to allow frame loading to complete
 						designState = DesignState::FRAME_LOADING_SETTLING;
@@ -114,7 +310,7 @@ namespace Design {
 						// Continue calibration
 						designState = DesignState::INIT_CALIBRATE;
 					}
-					stateStartTime = currentTime;
+					stateStartPoll = currentPoll;
 				}
 				break;
 				
@@ -125,7 +321,7 @@ namespace Design {
 				
 				if (stateWillChange) {
 					designState = DesignState::PALETTE_MENU_NEUTRAL;
-					stateStartTime = currentTime;
+					stateStartPoll = currentPoll;
 				}
 				break;
 				
@@ -135,7 +331,7 @@ namespace Design {
 				if (stateWillChange) {
 					// We are now in the palette menu, next we need to navigate to position 0
 					designState = DesignState::PALETTE_MENU_NAVIGATION;
-					stateStartTime = currentTime;
+					stateStartPoll = currentPoll;
 				}
 				break;
 				
@@ -164,7 +360,7 @@ namespace Design {
 						}
 						
 						designState = DesignState::PALETTE_NAV_NEUTRAL;
-						stateStartTime = currentTime;
+						stateStartPoll = currentPoll;
 					}
 				}
 				break;
@@ -180,7 +376,7 @@ namespace Design {
 						// Continue navigation
 						designState = DesignState::PALETTE_MENU_NAVIGATION;
 					}
-					stateStartTime = currentTime;
+					stateStartPoll = currentPoll;
 				}
 				break;
 				
@@ -190,7 +386,7 @@ namespace Design {
 				
 				if (stateWillChange) {
 					designState = DesignState::PALETTE_BUTTON_NEUTRAL;
-					stateStartTime = currentTime;
+					stateStartPoll = currentPoll;
 				}
 				break;
 				
@@ -209,7 +405,7 @@ namespace Design {
 						// Need to press A again
 						designState = DesignState::CHANGE_PALETTE_BUTTON;
 					}
-					stateStartTime = currentTime;
+					stateStartPoll = currentPoll;
 				}
 				break;
 				
@@ -220,7 +416,7 @@ namespace Design {
 				
 				if (stateWillChange) {
 					designState = DesignState::RETURN_CANVAS_NEUTRAL;
-					stateStartTime = currentTime;
+					stateStartPoll = currentPoll;
 				}
 				break;
 				
@@ -232,14 +428,9 @@ namespace Design {
 					// Reset current color to the lastColor that was active before palette change
 					currentColor = lastColor;
 					
-					// Start drawing pixels
-					// Initialize the first pixel to draw
-					targetX = 0;
-					targetY = 0;
-					const FrameData& currentFrame = getCurrentFrame();
-					targetColor = currentFrame.pixels[targetY][targetX] + 1; // +1 because UI has indices 1-15
-					designState = DesignState::SELECT_COLOR;
-					stateStartTime = currentTime;
+					// Start drawing pixels, the plan was made for this colour
+					designState = startDrawing();
+					stateStartPoll = currentPoll;
 				}
 				break;
 				
@@ -261,7 +452,7 @@ namespace Design {
 							if (stateWillChange) {
 								currentColor = 1;
 								designState = DesignState::SELECT_COLOR_NEUTRAL;
-								stateStartTime = currentTime;
+								stateStartPoll = currentPoll;
 							}
 							break;
 						}
@@ -302,12 +493,12 @@ namespace Design {
 								}
 							}
 							designState = DesignState::SELECT_COLOR_NEUTRAL;
-							stateStartTime = currentTime;
+							stateStartPoll = currentPoll;
 						}
 					} else {
-						// Already on the right color, draw the pixel
-						designState = DesignState::DRAW_PIXEL;
-						stateStartTime = currentTime;
+						// Already on the right color
+						designState = afterColorSelected();
+						stateStartPoll = currentPoll;
 					}
 				}
 				break;
@@ -317,13 +508,13 @@ namespace Design {
 				
 				if (stateWillChange) {
 					if (currentColor == targetColor) {
-						// We've reached the target color, draw the pixel
-						designState = DesignState::DRAW_PIXEL;
+						// We've reached the target color
+						designState = afterColorSelected();
 					} else {
 						// Continue color selection
 						designState = DesignState::SELECT_COLOR;
 					}
-					stateStartTime = currentTime;
+					stateStartPoll = currentPoll;
 				}
 				break;
 				
@@ -331,9 +522,9 @@ namespace Design {
 				// Press A to draw the pixel - needs longer duration to be recognized
 				report.a = 1;
 				
-				if (elapsed_us >= hold_duration_us * 2) { // Hold for 34000μs (twice the standard hold duration)
+				if (elapsedPolls >= timing.buttonPolls * 2) { // Hold for twice the standard button press
 					designState = DesignState::DRAW_PIXEL_NEUTRAL;
-					stateStartTime = currentTime;
+					stateStartPoll = currentPoll;
 				}
 				break;
 				
@@ -341,96 +532,33 @@ namespace Design {
 				// Neutral state after drawing a pixel - using standard duration
 				
 				if (stateWillChange) {
-					// Check if we've completed the current row/column
-					bool isDone = false;
-					bool needsVerticalMove = false;
-					
-					// Get the current frame
-					const FrameData& currentFrame = getCurrentFrame();
-					
-					// Calculate next position in snaking pattern
-					if (movingRight) {
-						// Moving right
-						if (targetX < 31) {
-							targetX++;
-						} else {
-							// End of row, move down and change direction
-							if (targetY < 31) {
-								targetY++;
-								movingRight = false;
-								needsVerticalMove = true;
-							} else {
-								// End of frame
-								isDone = true;
-							}
-						}
-					} else {
-						// Moving left
-						if (targetX > 0) {
-							targetX--;
-						} else {
-							// End of row, move down and change direction
-							if (targetY < 31) {
-								targetY++;
-								movingRight = true;
-								needsVerticalMove = true;
-							} else {
-								// End of frame
-								isDone = true;
-							}
-						}
-					}
-					
-					if (isDone) {
-						// Check if there's another frame to process
-						if (currentFrameset.currentFrameIndex + 1 < getFrameCount()) {
-							designState = DesignState::NEXT_FRAME;
-						} else {
-							// Frameset complete, exit design mode
-							designState = DesignState::EXIT_DESIGN;
-						}
-					} else {
-						// Get next target color
-						targetColor = currentFrame.pixels[targetY][targetX] + 1; // +1 because UI has indices 1-15
-						
-						// Determine if we need to move vertically or horizontally
-						if (needsVerticalMove) {
-							// Move down one row
-							designState = DesignState::MOVE_CURSOR;
-						} else {
-							// Continue in the same row
-							designState = DesignState::MOVE_CURSOR;
-						}
-					}
-					stateStartTime = currentTime;
+					planIndex++;
+					designState = nextPlanStep();
+					stateStartPoll = currentPoll;
 				}
 				break;
 				
 			case DesignState::MOVE_CURSOR:
-				// Move the cursor based on whether we need to move horizontally or vertically
-				if (targetY > design_currentY) {
-					// Need to move down
-					report.yStick = 0; // Down
-					if (stateWillChange) {
-						design_currentY++; // Update the current position
-					}
-				} else if (movingRight && targetX > design_currentX) {
-					// Moving right
+				// Diagonal while both axes are off target
+				if (targetX > design_currentX) {
 					report.xStick = 255; // Right
-					if (stateWillChange) {
-						design_currentX++; // Update the current position
-					}
-				} else if (!movingRight && targetX < design_currentX) {
-					// Moving left
+				} else if (targetX < design_currentX) {
 					report.xStick = 0; // Left
-					if (stateWillChange) {
-						design_currentX--; // Update the current position
-					}
+				}
+				if (targetY > design_currentY) {
+					report.yStick = 0; // Down
+				} else if (targetY < design_currentY) {
+					report.yStick = 255; // Up
 				}
 				
 				if (stateWillChange) {
+					// Update the current position
+					if (targetX > design_currentX) design_currentX++;
+					else if (targetX < design_currentX) design_currentX--;
+					if (targetY > design_currentY) design_currentY++;
+					else if (targetY < design_currentY) design_currentY--;
 					designState = DesignState::MOVE_CURSOR_NEUTRAL;
-					stateStartTime = currentTime;
+					stateStartPoll = currentPoll;
 				}
 				break;
 				
@@ -438,9 +566,54 @@ namespace Design {
 				// Neutral state after moving the cursor
 				
 				if (stateWillChange) {
-					// Now select the color for the next pixel
-					designState = DesignState::SELECT_COLOR;
-					stateStartTime = currentTime;
+					designState = atTarget() ? DesignState::DRAW_PIXEL : DesignState::MOVE_CURSOR;
+					stateStartPoll = currentPoll;
+				}
+				break;
+				
+			case DesignState::TOOL_MENU:
+				{
+					// One input of a tool menu sequence, A presses held like drawing a pixel
+					uint32_t holdFor = timing.holdPolls;
+					switch (menuSequence[menuStep]) {
+						case MenuInput::L:
+							report.l = 1;
+							report.analogL = 255;
+							holdFor = timing.buttonPolls;
+							break;
+						case MenuInput::UP:    report.yStick = 255; break;
+						case MenuInput::DOWN:  report.yStick = 0;   break;
+						case MenuInput::LEFT:  report.xStick = 0;   break;
+						case MenuInput::RIGHT: report.xStick = 255; break;
+						case MenuInput::A:
+							report.a = 1;
+							holdFor = timing.buttonPolls * 2;
+							break;
+					}
+					
+					if (elapsedPolls >= holdFor) {
+						menuStep++;
+						designState = DesignState::TOOL_MENU_NEUTRAL;
+						stateStartPoll = currentPoll;
+					}
+				}
+				break;
+				
+			case DesignState::TOOL_MENU_NEUTRAL:
+				// Neutral state between tool menu inputs
+				
+				if (stateWillChange) {
+					if (menuStep < menuLength) {
+						designState = DesignState::TOOL_MENU;
+					} else if (fillPending) {
+						// Canvas filled and the pen is back, draw what differs
+						fillPending = false;
+						designState = nextPlanStep();
+					} else {
+						currentTool = menuSequence == bucketSequence ? PatternPlanner::Tool::BUCKET : PatternPlanner::Tool::PEN;
+						designState = planIndex < framePlan.count ? afterColorSelected() : nextPlanStep();
+					}
+					stateStartPoll = currentPoll;
 				}
 				break;
 				
@@ -448,16 +621,19 @@ namespace Design {
 				// Move to the next frame
 				if (stateWillChange) {
 					currentFrameset.currentFrameIndex++;
+					framesSinceCalibration++;
 					
-					// Reset for the next frame
-					targetX = 0;
-					targetY = 0;
-					movingRight = true;
-					
-					// Reset calibration
-					designState = DesignState::INIT_CALIBRATE;
-					calibrationStep = 0;
-					stateStartTime = currentTime;
+					// The cursor is tracked and the canvas holds the last frame, so unless the policy asks for
+					// calibration the next one is planned from where the cursor is and only draws what changed
+					if (shouldRecalibrate()) {
+						// Touching the controller likely means a frame looked off, and a cursor that drifted
+						// put pixels in the wrong places, so the next frame is drawn in full
+						if (userInputSeen) canvasKnown = false;
+						designState = DesignState::INIT_CALIBRATE;
+					} else {
+						designState = DesignState::FRAME_LOADING_SETTLING;
+					}
+					stateStartPoll = currentPoll;
 				}
 				break;
 				
@@ -470,17 +646,16 @@ namespace Design {
 					
 					// Only do frame/palette setup once when entering this state
 					if (!frameSetupDone) {
-						targetX = 0;
-						targetY = 0;
-						const FrameData& currentFrame = getCurrentFrame();
-						targetColor = currentFrame.pixels[targetY][targetX] + 1; // +1 because UI has indices 1-15
+						// The palette menu puts the color cursor back where it was, so the plan starts from it either way
+						planFrame(timing);
 						
-						// Check if we need to change palette
+						// Check if we need to change palette. The canvas keeps its color indexes through a
+						// palette change, so the plan's changed pixels stay the same and are drawn in the new colors
 						targetPaletteId = getCurrentPaletteId();
 						frameSetupDone = true;
 					}
 					
-					if (elapsed_us >= hold_duration_us * 20) { // Wait for 20 standard durations
+					if (elapsedPolls >= timing.settlePolls) {
 						// Frame loading has settled, now check palette and start drawing
 						frameSetupDone = false; // Reset for next time this state is entered
 						
@@ -490,9 +665,9 @@ namespace Design {
 							designState = DesignState::MOVE_TO_PALETTE_MENU;
 						} else {
 							// Start drawing pixels
-							designState = DesignState::SELECT_COLOR;
+							designState = startDrawing();
 						}
-						stateStartTime = currentTime;
+						stateStartPoll = currentPoll;
 					}
 				}
 				break;
@@ -503,7 +678,7 @@ namespace Design {
 				
 				if (stateWillChange) {
 					designState = DesignState::EXIT_NEUTRAL;
-					stateStartTime = currentTime;
+					stateStartPoll = currentPoll;
 				}
 				break;
 				
@@ -513,7 +688,7 @@ namespace Design {
 				if (stateWillChange) {
 					// Exit design mode
 					inDesignMode = false;
-					stateStartTime = currentTime;
+					stateStartPoll = currentPoll;
 				}
 				break;
 				
@@ -531,7 +706,9 @@ namespace Design {
 		design_currentY = 0;
 		targetX = 0;
 		targetY = 0;
-		movingRight = true;
+		fillPending = false;
+		currentTool = PatternPlanner::Tool::PEN;
+		canvasKnown = false;
 		calibrationStep = 0;
 	}
 	
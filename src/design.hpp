@@ -8,7 +8,7 @@
 #include "types.hpp"
 
 // Function to check if a UTF-8 character is the paint emoji
-bool isPaintCharacter(const Utf8Char& c);
+bool isPaintCharacter(GlyphId c);
 
 namespace Design {
 	// Color structure
@@ -73,6 +73,8 @@ namespace Design {
 		DRAW_PIXEL_NEUTRAL,
 		MOVE_CURSOR,
 		MOVE_CURSOR_NEUTRAL,
+		TOOL_MENU,
+		TOOL_MENU_NEUTRAL,
 		NEXT_FRAME,
 		FRAME_LOADING_SETTLING,
 		EXIT_DESIGN,
@@ -80,12 +82,32 @@ namespace Design {
 		WAITING
 	};
 
+	// When the pattern cursor is pushed back into the top-left corner between frames. Design mode
+	// tracks it exactly, so recalibrating only guards against inputs the game may have dropped.
+	enum class RecalibrationPolicy {
+		NEVER,
+		EVERY_N_FRAMES,      // Every RECALIBRATE_EVERY_FRAMES frames
+		AFTER_USER_INPUT     // After the controller was touched, e.g. Start pressed on seeing a misdrawn frame
+	};
+
+	static const uint32_t RECALIBRATE_EVERY_FRAMES = 10;
+
+	void setRecalibrationPolicy(RecalibrationPolicy policy);
+	RecalibrationPolicy getRecalibrationPolicy();
+	const char* getRecalibrationPolicyName();
+
+	// Switches to the next policy, wrapping around, for the serial console
+	void nextRecalibrationPolicy();
+
+	// Called for every report the controller is touched in while design mode runs
+	void noteUserInput();
+
 	// Public interface functions
 	bool isInDesignMode();
 	
 	void enterDesignMode();
 	
-	void processDesign(GCReport& report, uint64_t hold_duration_us);
+	void processDesign(GCReport& report, const InputTiming& timing);
 	
 	void exitDesignMode();
 	
@@ -1,6 +1,7 @@
 #include "device.hpp"
 #include "simulatedController.hpp"
 #include "keymap.hpp"
+#include "glyphIndex.hpp"
 #include "townTunes.hpp"
 #include "controller.pio.h"
 #include "hardware/clocks.h"
@@ -102,6 +103,7 @@ void init_device_state(DeviceState* device, PIO pio, uint pin) {
 	device->device_id = 0;
 	device->initialized = false;
 	device->is_keyboard = false;
+	device->settling = false;
 	memset(&device->keyboard_state, 0, sizeof(KeyboardState));
 	tracker_init(&device->key_tracker);
 	
@@ -116,12 +118,12 @@ void init_device_state(DeviceState* device, PIO pio, uint pin) {
 bool detect_and_init_device(DeviceState* device) {
 	absolute_time_t now = get_absolute_time();
 
-	if (absolute_time_diff_us(device->next_retry_time, now) > 0) {
-		pio_sm_set_enabled(device->pio, device->sm, false);
-		pio_sm_clear_fifos(device->pio, device->sm);
-
-		controller_program_init(device->pio, device->sm, device->offset, device->pin);
-		sleep_ms(100);
+	// Let the line settle without blocking, core0 also has to keep the console's reports coming
+	if (device->settling) {
+		if (!time_reached(device->settle_time)) {
+			return false;
+		}
+		device->settling = false;
 
 		uint8_t response[8];
 		if (!transfer(device, CMD_RESET, sizeof(CMD_RESET), response, 3)) {
@@ -146,6 +148,16 @@ bool detect_and_init_device(DeviceState* device) {
 		return false;
 	}
 
+	if (absolute_time_diff_us(device->next_retry_time, now) > 0) {
+		pio_sm_set_enabled(device->pio, device->sm, false);
+		pio_sm_clear_fifos(device->pio, device->sm);
+
+		controller_program_init(device->pio, device->sm, device->offset, device->pin);
+		device->settle_time = make_timeout_time_ms(100);
+		device->settling = true;
+		return false;
+	}
+
 	return device->initialized;
 }
 
@@ -257,9 +269,9 @@ void handle_keyboard_controller(DeviceState* device, int device_num) {
 	for (int i = 0; i < 3; i++) {
 		if (keycodes[i] != 0 && keycodes[i] != 0x50) {
 			if (!tracker_is_active(&lastKeyTracker, keycodes[i])) {
-				Utf8Char c = translate_keycode(keycodes[i], device->keyboard_state.modifiers);
+				GlyphId c = translate_keycode(keycodes[i], device->keyboard_state.modifiers);
 				// Only add to keyBuffer if we're not in town tune mode
-				if (c.length > 0 && !in_town_tune_mode) {
+				if (c != GlyphIndex::NO_GLYPH && !in_town_tune_mode) {
 					keyBuffer.push(c);
 				}
 			}
@@ -1,9 +1,15 @@
 
 #include "display.hpp"
 #include "keymap.hpp"
+#include "glyphIndex.hpp"
+#include "pollTiming.hpp"
+#include "inputTuning.hpp"
+#include "cursorTracker.hpp"
+#include "serialInput.hpp"
+#include "predictor.hpp"
+#include "textField.hpp"
 #include <stdio.h>
 
-extern const char* virtualKeyboard[4][4][10];
 extern VirtualKeyboardPos currentPos;
 extern KeyBuffer keyBuffer;
 extern SimulatedState simulatedState;
@@ -17,6 +23,7 @@ void render_keyboard_state(KeyboardState* kb_state) {
 		return;
 	}
 
+	printf("Keymap: %s\n\x1B[K", get_keymap_name());
 	printf("Modifiers: %s%s%s\n\x1B[K",
 		(kb_state->modifiers & MOD_SHIFT) ? "SHIFT " : "      ",
 		(kb_state->modifiers & MOD_ALT) ? "ALT " : "    ",
@@ -30,13 +37,9 @@ void render_keyboard_state(KeyboardState* kb_state) {
 		uint8_t keycode = keycodes[i];
 		if (keycode != 0 && keycode != 0x54 && keycode != 0x55 && keycode != 0x57 && keycode != 0x53) {
 			has_active_keys = true;
-			Utf8Char c = translate_keycode(keycode, kb_state->modifiers);
-			if (c.length > 0) {
-				printf("[ ");
-				for (int j = 0; j < c.length; j++) {
-					putchar(c.bytes[j]);
-				}
-				printf(" ] ");
+			GlyphId c = translate_keycode(keycode, kb_state->modifiers);
+			if (c != GlyphIndex::NO_GLYPH) {
+				printf("[ %s ] ", GlyphIndex::toUtf8(c));
 			} else {
 				const char* key_name = get_key_name(keycode);
 				if (key_name) {
@@ -94,19 +97,38 @@ void render_virtual_keyboard_state() {
 	printf("=== Virtual Keyboard State ===\n\x1B[K");
 	printf("Calibration Status: %s\n\x1B[K", 
 		   simulatedState.keyboard_calibrated ? "Calibrated" : "Uncalibrated");
+	if (!simulatedState.keyboard_calibrated) {
+		CursorTracker::Range rows = CursorTracker::getRows();
+		CursorTracker::Range cols = CursorTracker::getCols();
+		printf("Cursor Somewhere In: Rows %d-%d, Cols %d-%d\n\x1B[K", rows.min, rows.max, cols.min, cols.max);
+	}
 	printf("Current Position: Layer %d, Row %d, Col %d\n\x1B[K", 
 		   currentPos.layer, currentPos.row, currentPos.col);
-	printf("Key Buffer [%zu/%zu]: ", keyBuffer.count, keyBuffer.BUFFER_SIZE);
-	if (keyBuffer.count > 0) {
-		size_t current = keyBuffer.readPos;
-		for (size_t i = 0; i < keyBuffer.count; i++) {
-			printf("%c ", keyBuffer.buffer[current]);
-			current = (current + 1) % keyBuffer.BUFFER_SIZE;
+	printf("Key Buffer [%zu/%zu, peak %zu, dropped %lu]: ", keyBuffer.size(), keyBuffer.BUFFER_SIZE,
+		   keyBuffer.highWater.load(std::memory_order_relaxed),
+		   (unsigned long)keyBuffer.dropped.load(std::memory_order_relaxed));
+	GlyphId glyph;
+	if (keyBuffer.peek(0, glyph)) {
+		for (size_t i = 0; keyBuffer.peek(i, glyph); i++) {
+			printf("%s ", GlyphIndex::toUtf8(glyph));
 		}
 	} else {
 		printf("empty");
 	}
 	printf("\n\x1B[K");
+
+	printf("Text Field: %zu glyphs%s\n\x1B[K", TextField::length(), TextField::isKnown() ? "" : " (unknown)");
+
+	Predictor::Stats predictor = Predictor::getStats();
+	printf("Predictor: %s, %lu resting moves, %lu hits, %lu misses, backing off for %lu\n\x1B[K",
+		   predictor.enabled ? "on" : "off", (unsigned long)predictor.predictions,
+		   (unsigned long)predictor.hits, (unsigned long)predictor.misses, (unsigned long)predictor.backoff);
+
+	SerialInput::Stats serial = SerialInput::getStats();
+	printf("Serial Input: %s, %lu typed, %lu rejected, %zu credits out, %lu kept and %lu erased by replacing\n\x1B[K",
+		   serial.streaming ? "streaming" : "idle",
+		   (unsigned long)serial.accepted, (unsigned long)serial.rejected, serial.outstanding,
+		   (unsigned long)serial.kept, (unsigned long)serial.erased);
 	
 	printf("Current Layer Layout:\n\x1B[K");
 	for (int row = 0; row < 4; row++) {
@@ -127,6 +149,49 @@ void render_virtual_keyboard_state() {
 	printf("\n\x1B[K");
 }
 
+void render_timing_info() {
+	PollTiming::Summary summary = PollTiming::getSummary();
+	printf("=== Console Poll Timing ===\n\x1B[K");
+	printf("Polls: %lu  Missed: %lu  Breaks: %lu  Late reports: %lu\n\x1B[K",
+		   (unsigned long)summary.polls, (unsigned long)summary.missedPolls, (unsigned long)summary.breaks,
+		   (unsigned long)summary.lateReports);
+	printf("Interval (us):       min %6lu  avg %6lu  max %6lu  p99 %6lu\n\x1B[K",
+		   (unsigned long)summary.intervalMinUs, (unsigned long)summary.intervalAvgUs,
+		   (unsigned long)summary.intervalMaxUs, (unsigned long)summary.intervalP99Us);
+	printf("Reply latency (us):  min %6lu  avg %6lu  max %6lu  p99 %6lu\n\x1B[K",
+		   (unsigned long)summary.latencyMinUs, (unsigned long)summary.latencyAvgUs,
+		   (unsigned long)summary.latencyMaxUs, (unsigned long)summary.latencyP99Us);
+	printf("Report compute (us): min %6lu  avg %6lu  max %6lu\n\x1B[K",
+		   (unsigned long)summary.producerMinUs, (unsigned long)summary.producerAvgUs,
+		   (unsigned long)summary.producerMaxUs);
+
+	const InputTuning::Cadence& cadence = InputTuning::getCadence();
+	static const char* sourceNames[] = { "defaults", "flash", "measured" };
+	if (cadence.refreshHz != 0) {
+		printf("Console: %luHz, %lu poll(s)/frame, %luus%s (%s%s)\n\x1B[K",
+			   (unsigned long)cadence.refreshHz, (unsigned long)cadence.pollsPerFrame, (unsigned long)cadence.periodUs,
+			   cadence.jittery ? ", jittery" : "", sourceNames[(int)cadence.source], cadence.saved ? ", saved" : "");
+	} else {
+		printf("Console: unknown cadence%s\n\x1B[K", cadence.periodUs != 0 ? ", using defaults" : "");
+	}
+	const InputTiming& timing = simulatedState.timing;
+	printf("Input timing (polls): tap %lu  button %lu  release %lu  menu %lu  settle %lu\n\x1B[K",
+		   (unsigned long)timing.holdPolls, (unsigned long)timing.buttonPolls, (unsigned long)timing.releasePolls,
+		   (unsigned long)timing.menuPolls, (unsigned long)timing.settlePolls);
+	printf("Key buffer: %zu/%zu waiting, peak %zu, dropped %lu\n\x1B[K", keyBuffer.size(), keyBuffer.BUFFER_SIZE,
+		   keyBuffer.highWater.load(std::memory_order_relaxed),
+		   (unsigned long)keyBuffer.dropped.load(std::memory_order_relaxed));
+
+	uint32_t intervals[8];
+	uint32_t count = PollTiming::getRecentIntervals(intervals, 8);
+	printf("Recent intervals (us):");
+	for (uint32_t i = 0; i < count; i++) {
+		printf(" %lu", (unsigned long)intervals[i]);
+	}
+	printf("\n\x1B[K\n\x1B[K");
+	fflush(stdout);
+}
+
 void render_device_section(DeviceState* device, int device_num) {
 	printf("=== Device %d ===\n\x1B[K", device_num);
 	if (device->initialized) {
@@ -146,5 +211,6 @@ void render_screen_update(DeviceState* device1, DeviceState* device2) {
 	render_device_section(device1, 1);
 	render_device_section(device2, 2);
 	render_virtual_keyboard_state();
+	render_timing_info();
 	fflush(stdout);
 }
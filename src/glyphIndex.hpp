@@ -0,0 +1,201 @@
+#pragma once
+
+#include <stdint.h>
+#include "types.hpp"
+#include "virtualKeyboard.hpp"
+
+// Compile-time lookup tables over the virtual keyboard: UTF-8 <-> glyph id, glyph id -> cells, and cell -> cell input costs
+namespace GlyphIndex {
+	static constexpr uint8_t LAYERS = 4;
+	static constexpr uint8_t ROWS = 4;
+	static constexpr uint8_t COLS = 10;
+	static constexpr uint8_t CELL_COUNT = LAYERS * ROWS * COLS;
+
+	// No glyph appears on more than one cell per layer
+	static constexpr uint8_t MAX_CELLS = LAYERS;
+
+	// Open addressing table, a power of two comfortably above the number of distinct glyphs
+	static constexpr uint32_t TABLE_BITS = 9;
+	static constexpr uint32_t TABLE_SIZE = 1u << TABLE_BITS;
+	static constexpr uint32_t MAX_PROBES = 4;
+
+	constexpr uint8_t cellIndex(uint8_t layer, uint8_t row, uint8_t col) {
+		return (layer * ROWS + row) * COLS + col;
+	}
+
+	constexpr uint8_t cellIndex(const VirtualKeyboardPos& pos) {
+		return cellIndex(pos.layer, pos.row, pos.col);
+	}
+
+	constexpr VirtualKeyboardPos cellPos(uint8_t cell) {
+		return { (uint8_t)(cell / (ROWS * COLS)), (uint8_t)(cell / COLS % ROWS), (uint8_t)(cell % COLS) };
+	}
+
+	// UTF-8 never contains a zero byte, so a glyph's bytes packed into an integer identify it (0 = empty slot)
+	constexpr uint64_t packGlyph(const char* glyph) {
+		uint64_t key = 0;
+		for (int i = 0; i < 8 && glyph[i] != 0; i++) {
+			key |= (uint64_t)(uint8_t)glyph[i] << (8 * i);
+		}
+		return key;
+	}
+
+	inline uint64_t packGlyph(const Utf8Char& glyph) {
+		uint64_t key = 0;
+		for (int i = 0; i < glyph.length && i < 8; i++) {
+			key |= (uint64_t)glyph.bytes[i] << (8 * i);
+		}
+		return key;
+	}
+
+	constexpr uint32_t slotFor(uint64_t key) {
+		return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> (64 - TABLE_BITS));
+	}
+
+	static constexpr GlyphId NO_GLYPH = 0;
+	static constexpr uint32_t MAX_GLYPHS = 256;
+
+	// Typed on the physical keyboard to switch modes, not on the in-game keyboard
+	inline constexpr const char* modeGlyphs[] = { "🔑", "🐸", "🎨", "🖌️" };
+
+	struct Glyph {
+		const char* text;
+		uint8_t count;
+		uint8_t cells[MAX_CELLS];
+	};
+
+	struct Slot {
+		uint64_t key;
+		GlyphId id;
+	};
+
+	// Glyphs are numbered in keyboard order from 1, followed by the mode glyphs
+	struct Table {
+		Glyph glyphs[MAX_GLYPHS];
+		Slot slots[TABLE_SIZE];
+		uint32_t glyphCount;
+		uint32_t longestProbe;
+	};
+
+	constexpr Slot& slotOf(Table& table, uint64_t key, uint32_t& probes) {
+		uint32_t slot = slotFor(key);
+		probes = 1;
+		while (table.slots[slot].key != 0 && table.slots[slot].key != key) {
+			slot = (slot + 1) & (TABLE_SIZE - 1);
+			probes++;
+		}
+		return table.slots[slot];
+	}
+
+	constexpr GlyphId addGlyph(Table& table, const char* text) {
+		uint32_t probes = 0;
+		Slot& slot = slotOf(table, packGlyph(text), probes);
+		if (slot.key == 0) {
+			slot.key = packGlyph(text);
+			slot.id = (GlyphId)++table.glyphCount;
+			table.glyphs[slot.id].text = text;
+		}
+		if (probes > table.longestProbe) table.longestProbe = probes;
+		return slot.id;
+	}
+
+	constexpr Table makeTable() {
+		Table table = {};
+		table.glyphs[NO_GLYPH].text = "";
+		for (uint8_t cell = 0; cell < CELL_COUNT; cell++) {
+			VirtualKeyboardPos pos = cellPos(cell);
+			Glyph& glyph = table.glyphs[addGlyph(table, virtualKeyboard[pos.layer][pos.row][pos.col])];
+			glyph.cells[glyph.count++] = cell;
+		}
+		for (const char* text : modeGlyphs) {
+			addGlyph(table, text);
+		}
+		return table;
+	}
+
+	inline constexpr Table table = makeTable();
+	static_assert(table.longestProbe <= MAX_PROBES, "Glyph hash clusters too much, change the multiplier or TABLE_BITS");
+	static_assert(table.glyphCount < MAX_GLYPHS, "Glyph ids must fit in a byte");
+
+	constexpr GlyphId findKey(uint64_t key) {
+		if (key == 0) return NO_GLYPH;
+		uint32_t slot = slotFor(key);
+		for (uint32_t probe = 0; probe < MAX_PROBES; probe++) {
+			const Slot& entry = table.slots[slot];
+			if (entry.key == key) return entry.id;
+			if (entry.key == 0) return NO_GLYPH;
+			slot = (slot + 1) & (TABLE_SIZE - 1);
+		}
+		return NO_GLYPH;
+	}
+
+	// UTF-8 to glyph id, NO_GLYPH if the glyph is unknown. Only needed where text enters the device.
+	constexpr GlyphId glyphId(const char* text) {
+		return findKey(packGlyph(text));
+	}
+
+	inline GlyphId glyphId(const Utf8Char& glyph) {
+		return findKey(packGlyph(glyph));
+	}
+
+	// Glyph id to UTF-8, "" for NO_GLYPH. Only needed where text leaves the device.
+	inline const char* toUtf8(GlyphId id) {
+		return table.glyphs[id].text;
+	}
+
+	static constexpr GlyphId ENTER = glyphId("↵");
+	static constexpr GlyphId SPACE = glyphId("␣");
+	static constexpr GlyphId KEY = glyphId("🔑");
+	static constexpr GlyphId FROG = glyphId("🐸");
+	static constexpr GlyphId PAINT = glyphId("🎨");
+	static_assert(ENTER != NO_GLYPH && SPACE != NO_GLYPH && KEY != NO_GLYPH && FROG != NO_GLYPH && PAINT != NO_GLYPH,
+				  "Special glyphs must be in the table");
+
+	// Glyph an A press types with the cursor on this cell
+	inline GlyphId glyphAt(const VirtualKeyboardPos& pos) {
+		return glyphId(virtualKeyboard[pos.layer][pos.row][pos.col]);
+	}
+
+	// Cells the glyph can be typed from, nullptr if it is not on the keyboard
+	inline const Glyph* find(GlyphId id) {
+		const Glyph& glyph = table.glyphs[id];
+		return glyph.count > 0 ? &glyph : nullptr;
+	}
+
+	// Shortest L/Y press sequences between layers, matching what processKeyBuffer presses
+	inline constexpr uint8_t layerSwitchCosts[LAYERS][LAYERS] = {
+		{ 0, 1, 1, 2 }, // 0: L -> 1, Y -> 2, Y Y -> 3
+		{ 1, 0, 1, 2 }, // 1: L -> 0, Y -> 2, Y Y -> 3
+		{ 2, 3, 0, 1 }, // 2: Y Y -> 0, Y Y L -> 1, Y -> 3
+		{ 1, 2, 2, 0 }  // 3: Y -> 0, Y L -> 1, Y Y -> 2
+	};
+
+	// Inputs to get from one cell to another, before pressing A: layer switches plus one stick tap per step.
+	// Taps go diagonal while both row and column differ. The keyboard does not wrap at its edges
+	// (calibration relies on pushing into the top left corner), so there are no wrapped paths.
+	struct CostMatrix {
+		uint8_t costs[CELL_COUNT][CELL_COUNT];
+	};
+
+	constexpr CostMatrix makeCostMatrix() {
+		CostMatrix matrix = {};
+		for (uint8_t from = 0; from < CELL_COUNT; from++) {
+			for (uint8_t to = 0; to < CELL_COUNT; to++) {
+				VirtualKeyboardPos a = cellPos(from);
+				VirtualKeyboardPos b = cellPos(to);
+				int rows = a.row > b.row ? a.row - b.row : b.row - a.row;
+				int cols = a.col > b.col ? a.col - b.col : b.col - a.col;
+				matrix.costs[from][to] = layerSwitchCosts[a.layer][b.layer] + (rows > cols ? rows : cols);
+			}
+		}
+		return matrix;
+	}
+
+	inline constexpr CostMatrix costMatrix = makeCostMatrix();
+
+	static_assert(costMatrix.costs[cellIndex(2, 0, 0)][cellIndex(1, 3, 9)] == 3 + 9, "Layer 2 -> 1 takes Y Y L, then 3 diagonal and 6 straight taps");
+
+	inline uint8_t moveCost(uint8_t from, uint8_t to) {
+		return costMatrix.costs[from][to];
+	}
+}
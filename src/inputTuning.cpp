@@ -0,0 +1,184 @@
+#include "inputTuning.hpp"
+#include "pollTiming.hpp"
+#include "joybus.hpp"
+#include "pico/multicore.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+extern SimulatedState simulatedState;
+
+// Last sector of flash, far past the program and its frame data
+static const uint32_t TUNING_FLASH_OFFSET = PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE;
+static const uint32_t TUNING_MAGIC = 0x54554E45; // "TUNE"
+static const uint32_t TUNING_VERSION = 2;
+
+// Longest wait for a poll to line the flash write up with, a console that has stopped polling doesn't delay it further
+static const uint32_t POLL_WAIT_US = 100000;
+
+struct StoredTuning {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t periodUs;
+	uint32_t refreshHz;
+	uint32_t pollsPerFrame;
+	uint32_t jittery;
+	InputTiming timing;
+	uint32_t checksum;
+};
+
+static_assert(sizeof(StoredTuning) <= FLASH_PAGE_SIZE, "Stored tuning must fit in one flash page");
+
+static InputTuning::Cadence cadence = { 0, 0, 1, false, InputTuning::Source::DEFAULTS, false };
+static bool measured = false;
+
+static uint32_t checksum(const StoredTuning& stored) {
+	const uint32_t* words = reinterpret_cast<const uint32_t*>(&stored);
+	uint32_t sum = 0x811C9DC5;
+	for (size_t i = 0; i < offsetof(StoredTuning, checksum) / sizeof(uint32_t); i++) {
+		sum = (sum ^ words[i]) * 16777619;
+	}
+	return sum;
+}
+
+static const StoredTuning* readStored() {
+	const StoredTuning* stored = reinterpret_cast<const StoredTuning*>(XIP_BASE + TUNING_FLASH_OFFSET);
+	if (stored->magic != TUNING_MAGIC || stored->version != TUNING_VERSION || stored->checksum != checksum(*stored)) {
+		return nullptr;
+	}
+	return stored;
+}
+
+static void writeStored(const StoredTuning& stored) {
+	uint8_t page[FLASH_PAGE_SIZE];
+	memset(page, 0xFF, sizeof(page));
+	memcpy(page, &stored, sizeof(stored));
+
+	// Core1 is parked in RAM and interrupts are off while flash is unavailable for execution, so
+	// polls during the sector erase (typically 45ms, up to 400ms) go unanswered and the console sees
+	// the controller drop for a moment. Starting right after a poll was answered keeps that to the
+	// fewest polls; update() only gets here the first time a console with a new cadence is measured.
+	uint32_t polls = getPollCount();
+	uint32_t waitStart = time_us_32();
+	while (getPollCount() == polls && time_us_32() - waitStart < POLL_WAIT_US) {
+		tight_loop_contents();
+	}
+	multicore_lockout_start_blocking();
+	uint32_t interrupts = save_and_disable_interrupts();
+	flash_range_erase(TUNING_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+	flash_range_program(TUNING_FLASH_OFFSET, page, FLASH_PAGE_SIZE);
+	restore_interrupts(interrupts);
+	multicore_lockout_end_blocking();
+}
+
+// Matches the poll period to a whole number of polls per frame of either video standard
+static bool classify(uint32_t periodUs, uint32_t& refreshHz, uint32_t& pollsPerFrame) {
+	static const struct { uint32_t hz; uint32_t frameUs; } standards[] = {
+		{ 60, InputTuning::NTSC_FRAME_US },
+		{ 50, InputTuning::PAL_FRAME_US },
+	};
+	uint32_t bestError = UINT32_MAX;
+	for (const auto& standard : standards) {
+		uint32_t polls = (standard.frameUs + periodUs / 2) / periodUs;
+		if (polls < 1 || polls > 4) continue;
+		uint32_t expected = standard.frameUs / polls;
+		uint32_t error = periodUs > expected ? periodUs - expected : expected - periodUs;
+		// Within 3% of the expected period
+		if (error * 33 <= expected && error < bestError) {
+			bestError = error;
+			refreshHz = standard.hz;
+			pollsPerFrame = polls;
+		}
+	}
+	return bestError != UINT32_MAX;
+}
+
+namespace InputTuning {
+
+	InputTiming deriveTiming(uint32_t pollsPerFrame, uint32_t refreshHz, bool jittery) {
+		uint32_t guard = GUARD_POLLS + (jittery ? 1 : 0);
+		InputTiming timing;
+		timing.pollsPerFrame = pollsPerFrame;
+		timing.holdPolls = TAP_FRAMES * pollsPerFrame + guard;
+		timing.buttonPolls = BUTTON_FRAMES * pollsPerFrame + guard;
+		timing.releasePolls = RELEASE_FRAMES * pollsPerFrame + guard;
+		timing.menuPolls = MENU_FRAMES * pollsPerFrame;
+		timing.settlePolls = SETTLE_FRAMES * pollsPerFrame;
+		timing.pollsPerSecond = refreshHz * pollsPerFrame;
+		return timing;
+	}
+
+	void init() {
+		const StoredTuning* stored = readStored();
+		if (stored == nullptr) {
+			simulatedState.timing = deriveTiming(1, 60, false);
+			return;
+		}
+		simulatedState.timing = stored->timing;
+		cadence.periodUs = stored->periodUs;
+		cadence.refreshHz = stored->refreshHz;
+		cadence.pollsPerFrame = stored->pollsPerFrame;
+		cadence.jittery = stored->jittery != 0;
+		cadence.source = Source::FLASH;
+		cadence.saved = true;
+	}
+
+	void update() {
+		// Called every main loop iteration, so the warmup check only reads the poll counter
+		if (measured || getPollCount() < WARMUP_POLLS) return;
+
+		uint32_t intervals[128];
+		uint32_t count = PollTiming::getRecentIntervals(intervals, 128);
+		if (count < 64) return;
+		measured = true;
+
+		// The median ignores the odd skipped poll, the spread to the 99th percentile shows jitter
+		std::sort(intervals, intervals + count);
+		uint32_t periodUs = intervals[count / 2];
+		uint32_t spreadUs = intervals[count * 99 / 100] - periodUs;
+
+		uint32_t refreshHz = 0;
+		uint32_t pollsPerFrame = 1;
+		if (!classify(periodUs, refreshHz, pollsPerFrame)) {
+			// Not a cadence we know, keep whatever timing we started with
+			cadence.periodUs = periodUs;
+			cadence.refreshHz = 0;
+			return;
+		}
+		bool jittery = spreadUs > periodUs / 4;
+
+		cadence.periodUs = periodUs;
+		cadence.refreshHz = refreshHz;
+		cadence.pollsPerFrame = pollsPerFrame;
+		cadence.jittery = jittery;
+		cadence.source = Source::MEASURED;
+		simulatedState.timing = deriveTiming(pollsPerFrame, refreshHz, jittery);
+
+		// Only touch flash when the console differs from the last one measured. The jitter flag can come
+		// out differently from one boot to the next on the same console, so on its own it is applied but
+		// not stored, which keeps the write to once per console rather than once per boot
+		const StoredTuning* previous = readStored();
+		if (previous != nullptr && previous->refreshHz == refreshHz && previous->pollsPerFrame == pollsPerFrame) {
+			cadence.saved = true;
+			return;
+		}
+
+		StoredTuning stored = {};
+		stored.magic = TUNING_MAGIC;
+		stored.version = TUNING_VERSION;
+		stored.periodUs = periodUs;
+		stored.refreshHz = refreshHz;
+		stored.pollsPerFrame = pollsPerFrame;
+		stored.jittery = jittery ? 1 : 0;
+		stored.timing = simulatedState.timing;
+		stored.checksum = checksum(stored);
+		writeStored(stored);
+		cadence.saved = true;
+	}
+
+	const Cadence& getCadence() {
+		return cadence;
+	}
+}
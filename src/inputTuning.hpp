@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+#include "types.hpp"
+
+namespace InputTuning {
+	// Frame lengths of the two console video standards
+	static const uint32_t NTSC_FRAME_US = 16683; // 59.94Hz
+	static const uint32_t PAL_FRAME_US = 20000;  // 50Hz
+
+	// Polls to observe after boot before trusting the measured cadence
+	static const uint32_t WARMUP_POLLS = 300;
+
+	// Per action class durations in game frames. Taps, presses and releases get one extra poll
+	// so a whole frame's pad read sees them whatever the phase between our polls and the game's read
+	static const uint32_t TAP_FRAMES = 1;
+	static const uint32_t BUTTON_FRAMES = 1;
+	static const uint32_t RELEASE_FRAMES = 1;
+	static const uint32_t GUARD_POLLS = 1;
+	static const uint32_t MENU_FRAMES = 14;
+	static const uint32_t SETTLE_FRAMES = 20;
+
+	enum class Source {
+		DEFAULTS,  // Nothing measured or stored yet
+		FLASH,     // Loaded from the last measurement
+		MEASURED   // Measured on this boot
+	};
+
+	struct Cadence {
+		uint32_t periodUs;       // Median interval between status polls
+		uint32_t refreshHz;      // 60 or 50, 0 while unknown
+		uint32_t pollsPerFrame;  // More than one on progressive scan or games polling faster than the video rate
+		bool jittery;            // Intervals spread enough that every input gets a poll of margin
+		Source source;
+		bool saved;              // The measurement has been written to flash
+	};
+
+	// Derives the durations of each action class for a console cadence
+	InputTiming deriveTiming(uint32_t pollsPerFrame, uint32_t refreshHz, bool jittery);
+
+	// Loads the last stored measurement into simulatedState.timing, call before the joybus loop starts
+	void init();
+
+	// Measures the cadence once enough polls have been seen, then applies and stores the result
+	void update();
+
+	const Cadence& getCadence();
+}
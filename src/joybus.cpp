@@ -3,7 +3,101 @@
 #include "pico/platform.h"
 #include "hardware/gpio.h"
 #include "hardware/pio.h"
+#include "hardware/dma.h"
 #include "joybus.pio.h"
+#include "pollTiming.hpp"
+
+#include <atomic>
+
+// Set to 0 to push replies into the TX FIFO from the CPU instead, e.g. to compare reply latency.
+// That comparison has not been made on a console yet, both paths are unmeasured: Ctrl+T prints the
+// "Reply latency" line for whichever one is built.
+#ifndef JOYBUS_REPLY_DMA
+#define JOYBUS_REPLY_DMA 1
+#endif
+
+// Double-buffered report slot shared by the producer on core0 and the joybus loop on core1.
+// The producer fills the buffer the console is not reading, then bumps reportSeq;
+// the joybus loop copies the buffer selected by reportSeq and retries if it was lapped mid-copy.
+static GCReport reportBuffers[2] = { defaultGcReport, defaultGcReport };
+static std::atomic<uint32_t> reportSeq(0);
+static std::atomic<uint32_t> sentSeq(0);
+static volatile uint32_t lateReportCount = 0;
+// Every status poll answered, the frame clock all input timing is counted in
+static std::atomic<uint32_t> pollCount(0);
+
+void publishReport(const GCReport& report) {
+	uint32_t seq = reportSeq.load(std::memory_order_relaxed) + 1;
+	reportBuffers[seq & 1] = report;
+	reportSeq.store(seq, std::memory_order_release);
+}
+
+bool needsReport() {
+	return sentSeq.load(std::memory_order_acquire) == reportSeq.load(std::memory_order_relaxed);
+}
+
+uint32_t getLateReportCount() {
+	return lateReportCount;
+}
+
+uint32_t getPollCount() {
+	return pollCount.load(std::memory_order_acquire);
+}
+
+static GCReport __time_critical_func(takeReport)() {
+	GCReport report;
+	uint32_t seq;
+	do {
+		seq = reportSeq.load(std::memory_order_acquire);
+		report = reportBuffers[seq & 1];
+		std::atomic_thread_fence(std::memory_order_acquire);
+	} while (reportSeq.load(std::memory_order_relaxed) - seq >= 2);
+
+	// Nothing new since the last poll: the producer fell behind, resend what we have
+	if (seq == sentSeq.load(std::memory_order_relaxed)) {
+		lateReportCount = lateReportCount + 1;
+	}
+	pollCount.store(pollCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	sentSeq.store(seq, std::memory_order_release);
+	return report;
+}
+
+// PIO words for one byte: 8 (enable, value) bit pairs, MSB first, for a right shifting OSR
+struct PioByteTable {
+	uint16_t entries[256];
+};
+
+static constexpr PioByteTable makePioByteTable() {
+	PioByteTable table = {};
+	for (int value = 0; value < 256; value++) {
+		uint16_t encoded = 0xAAAA; // Every pair enabled
+		for (int bit = 0; bit < 8; bit++) {
+			if (value & (1 << bit)) {
+				encoded |= 1 << (2 * (7 - bit));
+			}
+		}
+		table.entries[value] = encoded;
+	}
+	return table;
+}
+
+// The per-bit loop the table replaced, checked against every entry at compile time
+static constexpr bool matchesBitLoop(const PioByteTable& table) {
+	for (int value = 0; value < 256; value++) {
+		uint32_t result = 0;
+		for (int j = 0; j < 8; j++) {
+			result += 1 << (2 * j + 1);
+			result += (!!(value & (0x80u >> j))) << (2 * j);
+		}
+		if (table.entries[value] != result) return false;
+	}
+	return true;
+}
+
+static_assert(matchesBitLoop(makePioByteTable()), "PIO byte table does not match the bit loop encoding");
+
+// Kept in RAM with the time critical code so encoding a reply never waits on flash
+static const PioByteTable __not_in_flash("joybus_lut") pioByteTable = makePioByteTable();
 
 void __time_critical_func(convertToPio)(const uint8_t* command, const int len, uint32_t* result, int& resultLen) {
 	// PIO Shifts to the right by default
@@ -16,21 +110,57 @@ void __time_critical_func(convertToPio)(const uint8_t* command, const int len, u
 	}
 	resultLen = len/2 + 1;
 	int i;
-	for (i = 0; i < resultLen; i++) {
-		result[i] = 0;
-	}
-	for (i = 0; i < len; i++) {
-		for (int j = 0; j < 8; j++) {
-			result[i / 2] += 1 << (2 * (8 * (i % 2) + j) + 1);
-			result[i / 2] += (!!(command[i] & (0x80u >> j))) << (2 * (8 * (i % 2) + j));
-		}
+	for (i = 0; i + 1 < len; i += 2) {
+		result[i / 2] = pioByteTable.entries[command[i]] | ((uint32_t)pioByteTable.entries[command[i + 1]] << 16);
 	}
 	// End bit
-	result[len / 2] += 3 << (2 * (8 * (len % 2)));
+	if (len % 2) {
+		result[len / 2] = pioByteTable.entries[command[len - 1]] | (3u << 16);
+	} else {
+		result[len / 2] = 3;
+	}
 }
 
 
-void __time_critical_func(enterMode)(int dataPin, std::function<GCReport()> func) {
+static int replyDmaChannel = -1;
+static ReplyLatencyStats replyLatency = { 0, 0, UINT32_MAX, 0, 0 };
+
+ReplyLatencyStats getReplyLatencyStats() {
+	return replyLatency;
+}
+
+static uint32_t __time_critical_func(recordReplyLatency)(int dataPin, uint32_t commandEnd) {
+	// The line idles high between the command and our reply, so the first low is our start bit
+	uint32_t now;
+	do {
+		now = time_us_32();
+		if (now - commandEnd > 200) return UINT32_MAX; // Missed the edge, don't skew the stats
+	} while (gpio_get(dataPin));
+
+	// commandEnd is when IRQ 0 was seen, the line had already been idle for IDLE_DETECT_US by then
+	uint32_t latency = now - commandEnd + IDLE_DETECT_US;
+	replyLatency.count++;
+	replyLatency.lastUs = latency;
+	replyLatency.totalUs += latency;
+	if (latency < replyLatency.minUs) replyLatency.minUs = latency;
+	if (latency > replyLatency.maxUs) replyLatency.maxUs = latency;
+	return latency;
+}
+
+static uint32_t __time_critical_func(sendReply)(PIO pio, int dataPin, uint32_t commandEnd, const uint32_t* words, int len) {
+	// The state machine is already blocked on its first pull, no restart needed
+#if JOYBUS_REPLY_DMA
+	dma_channel_transfer_from_buffer_now(replyDmaChannel, words, len);
+	return recordReplyLatency(dataPin, commandEnd);
+#else
+	pio_sm_put_blocking(pio, 0, words[0]);
+	uint32_t latency = recordReplyLatency(dataPin, commandEnd);
+	for (int i = 1; i<len; i++) pio_sm_put_blocking(pio, 0, words[i]);
+	return latency;
+#endif
+}
+
+void __time_critical_func(enterMode)(int dataPin) {
 	gpio_init(dataPin);
 	gpio_set_dir(dataPin, GPIO_IN);
 	gpio_pull_up(dataPin);
@@ -45,64 +175,73 @@ void __time_critical_func(enterMode)(int dataPin, std::function<GCReport()> func
 	sm_config_set_in_pins(&config, dataPin);
 	sm_config_set_out_pins(&config, dataPin, 1);
 	sm_config_set_set_pins(&config, dataPin, 1);
+	sm_config_set_jmp_pin(&config, dataPin);
 	sm_config_set_clkdiv(&config, 5);
 	sm_config_set_out_shift(&config, true, false, 32);
 	sm_config_set_in_shift(&config, false, true, 8);
 	
-	pio_sm_init(pio, 0, offset, &config);
+	pio_sm_init(pio, 0, offset+joybus_offset_inmode, &config);
 	pio_sm_set_enabled(pio, 0, true);
+
+	// The reply channel always feeds the same TX FIFO, only the source and length change per reply
+	replyDmaChannel = dma_claim_unused_channel(true);
+	dma_channel_config dmaConfig = dma_channel_get_default_config(replyDmaChannel);
+	channel_config_set_transfer_data_size(&dmaConfig, DMA_SIZE_32);
+	channel_config_set_read_increment(&dmaConfig, true);
+	channel_config_set_write_increment(&dmaConfig, false);
+	channel_config_set_dreq(&dmaConfig, pio_get_dreq(pio, 0, true));
+	dma_channel_configure(replyDmaChannel, &dmaConfig, &pio->txf[0], nullptr, 0, false);
+
+	// Constant replies are encoded once instead of on every command
+	const uint8_t probeResponse[3] = { 0x09, 0x00, 0x03 };
+	uint32_t probeResult[2];
+	int probeResultLen;
+	convertToPio(probeResponse, 3, probeResult, probeResultLen);
+
+	const uint8_t originResponse[10] = { 0x00, 0x80, 128, 128, 128, 128, 0, 0, 0, 0 };
+	uint32_t originResult[6];
+	int originResultLen;
+	convertToPio(originResponse, 10, originResult, originResultLen);
+
+	// Outlives each loop iteration since the DMA may still be reading it
+	uint32_t statusResult[5];
+	int statusResultLen;
 	
 	while (true) {
-		uint8_t buffer[3];
-		buffer[0] = pio_sm_get_blocking(pio, 0);
-
-		if (buffer[0] == 0) { // Probe
-			uint8_t probeResponse[3] = { 0x09, 0x00, 0x03 };
-			uint32_t result[2];
-			int resultLen;
-			convertToPio(probeResponse, 3, result, resultLen);
-			sleep_us(6);
-
-			pio_sm_set_enabled(pio, 0, false);
-			pio_sm_init(pio, 0, offset+joybus_offset_outmode, &config);
-			pio_sm_set_enabled(pio, 0, true);
-
-			for (int i = 0; i<resultLen; i++) pio_sm_put_blocking(pio, 0, result[i]);
+		// IRQ 0 is raised once the line has gone idle after a command, by then all its bytes have been pushed.
+		// Drain while waiting so an over-long command can't stall the PIO on a full RX FIFO
+		uint8_t buffer[4];
+		int len = 0;
+		while (!pio_interrupt_get(pio, 0)) {
+			if (!pio_sm_is_rx_fifo_empty(pio, 0)) {
+				uint8_t byte = pio_sm_get(pio, 0);
+				if (len < 4) buffer[len] = byte;
+				len++;
+			}
 		}
-		else if (buffer[0] == 0x41) { // Origin
-			uint8_t originResponse[10] = { 0x00, 0x80, 128, 128, 128, 128, 0, 0, 0, 0 };
-			uint32_t result[6];
-			int resultLen;
-			convertToPio(originResponse, 10, result, resultLen);
-
-			pio_sm_set_enabled(pio, 0, false);
-			pio_sm_init(pio, 0, offset+joybus_offset_outmode, &config);
-			pio_sm_set_enabled(pio, 0, true);
-
-			for (int i = 0; i<resultLen; i++) pio_sm_put_blocking(pio, 0, result[i]);
+		uint32_t commandEnd = time_us_32();
+		while (!pio_sm_is_rx_fifo_empty(pio, 0)) {
+			uint8_t byte = pio_sm_get(pio, 0);
+			if (len < 4) buffer[len] = byte;
+			len++;
 		}
-		else if (buffer[0] == 0x40) {
-			buffer[0] = pio_sm_get_blocking(pio, 0);
-			buffer[0] = pio_sm_get_blocking(pio, 0);
-
-			GCReport gcReport = func();
+		pio_interrupt_clear(pio, 0);
 
-			uint32_t result[5];
-			int resultLen;
-			convertToPio((uint8_t*)(&gcReport), 8, result, resultLen);
-
-			pio_sm_set_enabled(pio, 0, false);
-			pio_sm_init(pio, 0, offset+joybus_offset_outmode, &config);
-			pio_sm_set_enabled(pio, 0, true);
-
-			for (int i = 0; i<resultLen; i++) pio_sm_put_blocking(pio, 0, result[i]);
+		if (len == 1 && buffer[0] == 0) { // Probe
+			sendReply(pio, dataPin, commandEnd, probeResult, probeResultLen);
+		}
+		else if (len == 1 && buffer[0] == 0x41) { // Origin
+			sendReply(pio, dataPin, commandEnd, originResult, originResultLen);
+		}
+		else if (len == 3 && buffer[0] == 0x40) {
+			GCReport gcReport = takeReport();
+			convertToPio((uint8_t*)(&gcReport), 8, statusResult, statusResultLen);
+			uint32_t latency = sendReply(pio, dataPin, commandEnd, statusResult, statusResultLen);
+			PollTiming::recordPoll(commandEnd, latency);
 		}
 		else {
-			pio_sm_set_enabled(pio, 0, false);
-			sleep_us(400);
-			pio_sm_init(pio, 0, offset+joybus_offset_inmode, &config);
-			pio_sm_set_enabled(pio, 0, true);
+			// Unknown command or a glitch, the PIO has already resynchronised on the idle line
+			pio_sm_put(pio, 0, 0);
 		}
 	}
 }
-
@@ -4,14 +4,63 @@
 #include "pico/stdlib.h"
 #include "gcReport.hpp"
 
-#include <functional>
-
 /**
  * @short Enters the Joybus communication mode
  * 
+ * Polls are answered with the latest report handed over through publishReport(),
+ * so no mode logic runs between the console's command and our reply.
+ * 
  * @param dataPin GPIO number of the console data line pin
- * @param func Function to be called to obtain the GCReport to be sent to the console
  */
-void enterMode(int dataPin, std::function<GCReport()> func);
+void enterMode(int dataPin);
+
+/**
+ * @short Hands the report for the next console poll over to the Joybus loop
+ * 
+ * @param report GCReport to be sent to the console
+ */
+void publishReport(const GCReport& report);
+
+/**
+ * @short Whether the last published report has been sent and the next one is due
+ */
+bool needsReport();
+
+/**
+ * @short Number of polls answered with an already sent report because no new one was published in time
+ */
+uint32_t getLateReportCount();
+
+/**
+ * @short Number of status polls answered so far
+ * 
+ * The console polls once per game frame, so this is the time base for holding and releasing inputs.
+ * It only advances while a console is polling.
+ */
+uint32_t getPollCount();
+
+/**
+ * @short How long after a command's stop bit the PIO flags its end with IRQ 0: the line has to stay
+ * high for 32 passes of 4 cycles at clk_sys / 5, 128 cycles or 5.12us at 125 MHz (rounded down here)
+ */
+static const uint32_t IDLE_DETECT_US = 5;
+
+/**
+ * @short Time from the end of a command's stop bit to the first falling edge of our reply, in microseconds.
+ * It is timed from IRQ 0 with IDLE_DETECT_US added back, so it stays comparable with timings taken
+ * from the stop bit itself.
+ */
+struct ReplyLatencyStats {
+	uint32_t count;
+	uint32_t lastUs;
+	uint32_t minUs;
+	uint32_t maxUs;
+	uint64_t totalUs;
+};
+
+/**
+ * @short Snapshot of the reply latency measured on core1 (fields may be mid-update, diagnostics only)
+ */
+ReplyLatencyStats getReplyLatencyStats();
 
 #endif
\ No newline at end of file
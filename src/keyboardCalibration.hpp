@@ -3,42 +3,56 @@ namespace KeyboardCalibration {
 		uint8_t xStick;
 		uint8_t yStick;
 	};
-	
-	static const CalibMove sequence[] = {
-		{0, 128},    // left
-		{128, 255},  // up
-		{0, 128},    // left
-		{128, 255},  // up
-		{0, 128},    // left
-		{128, 255},  // up
-		{0, 128},    // left
-		{128, 128},  // neutral
-		{0, 128},    // left
-		{128, 128},  // neutral
-		{0, 128},    // left
-		{128, 128},  // neutral
-		{0, 128},    // left
-		{128, 128},  // neutral
-		{0, 128},    // left
-		{128, 128},  // neutral
-		{0, 128}     // final left
-	};
-	
+
+	static const CalibMove LEFT = {0, 128};
+	static const CalibMove RIGHT = {255, 128};
+	static const CalibMove UP = {128, 255};
+	static const CalibMove DOWN = {128, 0};
+	static const CalibMove NEUTRAL = {128, 128};
+
+	// Enough for pushing across the whole keyboard on both axes
+	static const size_t MAX_MOVES = 2 * (9 + 3);
+
+	static CalibMove sequence[MAX_MOVES];
+	static size_t sequenceLength = 0;
 	static size_t currentMove = 0;
-	
-	inline void reset() {
+
+	// Taps the cursor into an edge on each axis. Taps alternate between the axes while both
+	// still need some (the stick changes direction so no neutral is needed in between),
+	// then the remaining same-direction taps are separated by neutral.
+	inline void plan(const CalibMove& horizontal, uint8_t horizontalTaps, const CalibMove& vertical, uint8_t verticalTaps) {
+		sequenceLength = 0;
 		currentMove = 0;
+		while (horizontalTaps > 0 && verticalTaps > 0) {
+			sequence[sequenceLength++] = horizontal;
+			sequence[sequenceLength++] = vertical;
+			horizontalTaps--;
+			verticalTaps--;
+		}
+		const CalibMove& remaining = horizontalTaps > 0 ? horizontal : vertical;
+		uint8_t remainingTaps = horizontalTaps > 0 ? horizontalTaps : verticalTaps;
+		for (uint8_t i = 0; i < remainingTaps; i++) {
+			if (sequenceLength > 0 && i > 0) {
+				sequence[sequenceLength++] = NEUTRAL;
+			}
+			sequence[sequenceLength++] = remaining;
+		}
+	}
+
+	// From anywhere into the top left corner: left, up, left, up, left, up, left, neutral, left, ...
+	inline void reset() {
+		plan(LEFT, 9, UP, 3);
 	}
-	
+
 	inline bool isComplete() {
-		return currentMove >= sizeof(sequence) / sizeof(sequence[0]);
+		return currentMove >= sequenceLength;
 	}
-	
+
 	inline const CalibMove& getCurrentMove() {
 		return sequence[currentMove];
 	}
-	
+
 	inline void advance() {
 		currentMove++;
 	}
-}
\ No newline at end of file
+}
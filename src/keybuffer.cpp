@@ -1,21 +1,64 @@
 #include "types.hpp"
 
-bool KeyBuffer::push(const Utf8Char& c) {
-	if (count >= BUFFER_SIZE) return false;
-	buffer[writePos] = c;
-	writePos = (writePos + 1) % BUFFER_SIZE;
-	count++;
+bool KeyBuffer::tryPush(GlyphId c) {
+	size_t write = writePos.load(std::memory_order_relaxed);
+	size_t waiting = write - readPos.load(std::memory_order_acquire);
+	if (waiting >= BUFFER_SIZE) return false;
+	buffer[write & MASK] = c;
+	writePos.store(write + 1, std::memory_order_release);
+	if (waiting + 1 > highWater.load(std::memory_order_relaxed)) {
+		highWater.store(waiting + 1, std::memory_order_relaxed);
+	}
 	return true;
 }
 
-bool KeyBuffer::pop(Utf8Char& c) {
-	if (count == 0) return false;
-	c = buffer[readPos];
-	readPos = (readPos + 1) % BUFFER_SIZE;
-	count--;
+bool KeyBuffer::push(GlyphId c) {
+	if (tryPush(c)) return true;
+	dropped.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+size_t KeyBuffer::freeSlots() const {
+	return BUFFER_SIZE - (writePos.load(std::memory_order_relaxed) - readPos.load(std::memory_order_acquire));
+}
+
+// Producer and consumer each announce their claim on the last glyph before checking the other's,
+// so at most one of pop() and retract() gets it (possibly neither, then it stays queued)
+bool KeyBuffer::retract(GlyphId& c) {
+	size_t write = writePos.load(std::memory_order_relaxed);
+	if (write == readPos.load(std::memory_order_acquire)) return false;
+	c = buffer[(write - 1) & MASK];
+	writePos.store(write - 1, std::memory_order_seq_cst);
+	if (readPos.load(std::memory_order_seq_cst) == write) {
+		writePos.store(write, std::memory_order_release);
+		return false;
+	}
+	return true;
+}
+
+bool KeyBuffer::pop(GlyphId& c) {
+	size_t read = readPos.load(std::memory_order_relaxed);
+	if (read == writePos.load(std::memory_order_acquire)) return false;
+	c = buffer[read & MASK];
+	readPos.store(read + 1, std::memory_order_seq_cst);
+	if (writePos.load(std::memory_order_seq_cst) == read) {
+		readPos.store(read, std::memory_order_release);
+		return false;
+	}
+	return true;
+}
+
+bool KeyBuffer::peek(size_t offset, GlyphId& c) const {
+	size_t read = readPos.load(std::memory_order_relaxed);
+	if (offset >= writePos.load(std::memory_order_acquire) - read) return false;
+	c = buffer[(read + offset) & MASK];
 	return true;
 }
 
 bool KeyBuffer::isEmpty() const {
-	return count == 0;
+	return size() == 0;
+}
+
+size_t KeyBuffer::size() const {
+	return writePos.load(std::memory_order_acquire) - readPos.load(std::memory_order_relaxed);
 }
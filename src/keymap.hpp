@@ -1,12 +1,29 @@
 #pragma once
 
 #include "types.hpp"
+#include "virtualKeyboard.hpp"
+
+// Modifier state bits a keymap is indexed by
+#define KEYMAP_SHIFT 0x01
+#define KEYMAP_ALT   0x02
+#define KEYMAP_CAPS  0x04
+#define KEYMAP_MODIFIER_STATES 8
+
+#define KEYMAP_COUNT 2
+
+// Keycode and modifier state to glyph, resolved at compile time so a keypress is one load from flash
+struct Keymap {
+	const char* name;
+	GlyphId glyphs[256][KEYMAP_MODIFIER_STATES];
+	uint32_t unknownGlyphs; // Mapped strings that are not in GlyphIndex, checked at compile time
+};
 
-void init_keymap();
 const char* get_key_name(uint8_t keycode);
-Utf8Char translate_keycode(uint8_t keycode, uint8_t modifiers);
+GlyphId translate_keycode(uint8_t keycode, uint8_t modifiers);
 
-extern KeyMapping keymap[256];
-extern bool caps_lock_active;
+// Keymaps can be switched at runtime, e.g. from the serial console
+void select_keymap(uint8_t index);
+uint8_t get_keymap_index();
+const char* get_keymap_name();
 
-extern const char* virtualKeyboard[4][4][10];
\ No newline at end of file
+extern bool caps_lock_active;
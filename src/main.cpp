@@ -6,6 +6,9 @@
 #include "pico/multicore.h"
 #include "joybus.hpp"
 #include "snake.hpp"
+#include "pollTiming.hpp"
+#include "inputTuning.hpp"
+#include "serialInput.hpp"
 #include <stdio.h>
 
 // Global variables
@@ -15,7 +18,6 @@ KeyBuffer keyBuffer;
 
 int main() {
 	stdio_init_all();
-	init_keymap();
 	sleep_ms(1000);
 	
 	printf("\x1B[2J");
@@ -23,9 +25,12 @@ int main() {
 	
 	init_device_state(&device1, pio0, GPIO_INPUT_PIN_1);
 	init_device_state(&device2, pio0, GPIO_INPUT_PIN_2);
+	InputTuning::init();
 
 	multicore_launch_core1([]() {
-		enterMode(GPIO_OUTPUT_PIN, getControllerState);
+		// Lets core0 pause us while it writes the measured timing to flash
+		multicore_lockout_victim_init();
+		enterMode(GPIO_OUTPUT_PIN);
 	});
 
 	absolute_time_t last_poll_1 = get_absolute_time();
@@ -65,6 +70,18 @@ int main() {
 		}
 		
 		Snake::updateSnakeDirection();
+		InputTuning::update();
+
+		// Prepare the next report as soon as the console has taken the previous one
+		if (needsReport()) {
+			uint32_t produceStart = time_us_32();
+			GCReport report = getControllerState();
+			PollTiming::recordProducerTime(time_us_32() - produceStart);
+			publishReport(report);
+		}
+
+		// Text streamed over USB serial, and Ctrl+T for the poll timing statistics
+		SerialInput::poll();
 	}
 	
 	return 0;
@@ -1,6 +1,7 @@
 #include "nookCodes.hpp"
 #include "simulatedController.hpp"
 #include "types.hpp"
+#include "glyphIndex.hpp"
 #include <cstdio>
 #include <cstdlib>
 #include <cctype>
@@ -10,7 +11,7 @@
 
 // Static variables for nook code mode
 static bool inNookCodeMode = false;
-static std::vector<Utf8Char> itemName;
+static std::vector<GlyphId> itemName;
 static bool needToClearBuffer = false;
 static bool needToPressStart = false;
 static const size_t MAX_ITEM_NAME_LENGTH = 28;
@@ -18,40 +19,23 @@ static const size_t MAX_ITEM_NAME_LENGTH = 28;
 // External references
 extern KeyBuffer keyBuffer;
 
-// Utility functions for string and UTF-8 handling
-std::string utf8CharsToString(const std::vector<Utf8Char>& chars) {
-	std::string result;
-	for (const auto& c : chars) {
-		result.append(reinterpret_cast<const char*>(c.bytes), c.length);
-	}
-	return result;
-}
-
-void convertStringToUtf8Chars(const std::string& str, std::vector<Utf8Char>& chars) {
-	size_t i = 0;
-	while (i < str.length()) {
-		Utf8Char c;
-		size_t charLen = 1;
-		
-		// Determine UTF-8 character length
-		if ((str[i] & 0x80) == 0) charLen = 1;
-		else if ((str[i] & 0xE0) == 0xC0) charLen = 2;
-		else if ((str[i] & 0xF0) == 0xE0) charLen = 3;
-		else if ((str[i] & 0xF8) == 0xF0) charLen = 4;
-		
-		c.length = charLen;
-		for (size_t j = 0; j < charLen && i < str.length(); j++) {
-			c.bytes[j] = str[i++];
+// Utility functions for UTF-8 handling
+void convertStringToGlyphIds(const char* str, std::vector<GlyphId>& glyphs) {
+	while (*str) {
+		Utf8Char c = {};
+		int charLen = Utf8String::getUtf8ByteCount(*str);
+		for (int j = 0; j < charLen && *str; j++) {
+			c.bytes[c.length++] = *str++;
+		}
+		GlyphId glyph = GlyphIndex::glyphId(c);
+		if (glyph != GlyphIndex::NO_GLYPH) {
+			glyphs.push_back(glyph);
 		}
-		chars.push_back(c);
 	}
 }
 
-bool isKeyCharacter(const Utf8Char& c) {
-	// Compare with UTF-8 bytes for 🔑
-	static const uint8_t keyChar[] = {0xF0, 0x9F, 0x94, 0x91};
-	if (c.length != 4) return false;
-	return memcmp(c.bytes, keyChar, 4) == 0;
+bool isKeyCharacter(GlyphId c) {
+	return c == GlyphIndex::KEY;
 }
 
 namespace NookCodes {
@@ -80,7 +64,7 @@ namespace NookCodes {
 		needToPressStart = false;
 	}
 	
-	std::vector<Utf8Char>& getItemName() {
+	std::vector<GlyphId>& getItemName() {
 		return itemName;
 	}
 
@@ -104,26 +88,22 @@ namespace NookCodes {
 		return false;
 	}
 
-	void addCharToItemName(const Utf8Char& c) {
+	void addCharToItemName(GlyphId c) {
 		if (itemName.size() < MAX_ITEM_NAME_LENGTH) {
 			itemName.push_back(c);
 		}
 	}
 
 	bool checkAndProcessNookCode() {
-		std::string currentItem = utf8CharsToString(itemName);
-		// Convert to lowercase and replace special space character (␣, UTF-8: E2 90 A3)
+		// Convert to lowercase and replace the special space character (␣)
 		std::string processedItem;
-		for (size_t i = 0; i < currentItem.length(); i++) {
-			// Check for UTF-8 sequence of ␣ (E2 90 A3)
-			if (i + 2 < currentItem.length() && 
-				(unsigned char)currentItem[i] == 0xE2 && 
-				(unsigned char)currentItem[i+1] == 0x90 && 
-				(unsigned char)currentItem[i+2] == 0xA3) {
+		for (GlyphId glyph : itemName) {
+			if (glyph == GlyphIndex::SPACE) {
 				processedItem += ' ';
-				i += 2;  // Skip the next two bytes since we consumed them
 			} else {
-				processedItem += std::tolower(currentItem[i]);
+				for (const char* c = GlyphIndex::toUtf8(glyph); *c; c++) {
+					processedItem += std::tolower((unsigned char)*c);
+				}
 			}
 		}
 			
@@ -132,10 +112,10 @@ namespace NookCodes {
 			// Set flag to clear buffer first
 			needToClearBuffer = true;
 			// Store the code to be processed after clearing
-			std::vector<Utf8Char> codeChars;
-			convertStringToUtf8Chars(code, codeChars);
+			std::vector<GlyphId> codeChars;
+			convertStringToGlyphIds(code, codeChars);
 			keyBuffer.clear();
-			for (const auto& c : codeChars) {
+			for (GlyphId c : codeChars) {
 				keyBuffer.push(c);
 			}
 			needToPressStart = true;
@@ -5,9 +5,8 @@
 #include "types.hpp"
 
 // Forward declarations
-std::string utf8CharsToString(const std::vector<Utf8Char>& chars);
-void convertStringToUtf8Chars(const std::string& str, std::vector<Utf8Char>& chars);
-bool isKeyCharacter(const Utf8Char& c);
+void convertStringToGlyphIds(const char* str, std::vector<GlyphId>& glyphs);
+bool isKeyCharacter(GlyphId c);
 
 namespace NookCodes {
 	struct CodePair {
@@ -1447,7 +1446,7 @@ namespace NookCodes {
 	void clearNeedToPressStart();
 	
 	// Get reference to the item name
-	std::vector<Utf8Char>& getItemName();
+	std::vector<GlyphId>& getItemName();
 	
 	// Enter nook code mode
 	void enterNookCodeMode();
@@ -1459,7 +1458,7 @@ namespace NookCodes {
 	bool processBackspace();
 	
 	// Add a character to the item name
-	void addCharToItemName(const Utf8Char& c);
+	void addCharToItemName(GlyphId c);
 	
 	// Check and process nook code
 	bool checkAndProcessNookCode();
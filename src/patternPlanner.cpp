@@ -0,0 +1,518 @@
+#include "patternPlanner.hpp"
+
+using PatternPlanner::COLORS;
+using PatternPlanner::PIXELS;
+using PatternPlanner::SIZE;
+using PatternPlanner::Cost;
+using PatternPlanner::Weights;
+
+static const uint16_t NONE = UINT16_MAX;
+
+// Pixels as y * SIZE + x, grouped by colour for the pass being routed
+static uint16_t passPixels[PIXELS];
+
+// The frame split into 4-connected regions of one colour
+static uint16_t regionOf[PIXELS];
+static uint8_t regionColor[PIXELS];
+static uint16_t regionSize[PIXELS];
+static uint16_t regionCount = 0;
+
+// Colour bits of a pixel's neighbours in other regions, 0 away from a region's border
+static uint16_t neighbourColors[PIXELS];
+
+// Per region for the pass order being planned: border pixels that have to be penned before a bucket
+// press stays inside it, the presses its remaining pixels need, and whether it gets filled
+static uint16_t regionSeal[PIXELS];
+static uint16_t regionPresses[PIXELS];
+static bool regionFilled[PIXELS];
+
+// Breadth first queue, then which bucket press covers each pixel left after sealing
+static uint16_t queue[PIXELS];
+static uint16_t pressOf[PIXELS];
+
+// The plan with the canvas filled first, kept if it beats drawing every pixel
+static PatternPlanner::Plan filledPlan;
+
+static uint8_t pixelX(uint16_t pixel) {
+	return pixel % SIZE;
+}
+
+static uint8_t pixelY(uint16_t pixel) {
+	return pixel / SIZE;
+}
+
+static uint8_t distance(uint16_t a, uint16_t b) {
+	return PatternPlanner::moveDistance(pixelX(a), pixelY(a), pixelX(b), pixelY(b));
+}
+
+/**
+ * Order to visit the colours in, starting from `start`. Whatever order, the C-stick sweeps an arc of
+ * the ring that holds every colour needed: it goes to one end of it, comes back and goes to the
+ * other, so the cheapest plan covers the arc with the shorter side first.
+ */
+static void orderColors(const uint16_t counts[], uint8_t start, uint8_t order[], uint8_t& orderCount) {
+	// Steps up (towards 1, wrapping to 15) and down (towards 15, wrapping to 1) the arc reaches
+	uint8_t bestUp = 0;
+	uint8_t bestDown = 0;
+	uint32_t bestCost = UINT32_MAX;
+	for (uint8_t up = 0; up < COLORS; up++) {
+		for (uint8_t down = 0; up + down < COLORS; down++) {
+			bool coversAll = true;
+			for (uint8_t color = 1; color <= COLORS && coversAll; color++) {
+				if (counts[color] == 0) continue;
+				uint8_t stepsDown = (color - start + COLORS) % COLORS;
+				uint8_t stepsUp = (start - color + COLORS) % COLORS;
+				coversAll = stepsUp <= up || stepsDown <= down;
+			}
+			uint32_t cost = up + down + (up < down ? up : down);
+			if (coversAll && cost < bestCost) {
+				bestCost = cost;
+				bestUp = up;
+				bestDown = down;
+			}
+		}
+	}
+
+	orderCount = 0;
+	if (counts[start] > 0) order[orderCount++] = start;
+	bool upFirst = bestUp <= bestDown;
+	for (uint8_t side = 0; side < 2; side++) {
+		bool goingUp = (side == 0) == upFirst;
+		uint8_t reach = goingUp ? bestUp : bestDown;
+		for (uint8_t step = 1; step <= reach; step++) {
+			uint8_t color = goingUp ? (start - 1 - step + COLORS) % COLORS + 1 : (start - 1 + step) % COLORS + 1;
+			if (counts[color] > 0) order[orderCount++] = color;
+		}
+	}
+}
+
+// Nearest neighbour tour from `from` over the pass, in place
+static void nearestNeighbour(uint16_t* pixels, uint16_t count, uint16_t from) {
+	for (uint16_t i = 0; i < count; i++) {
+		uint16_t nearest = i;
+		uint8_t nearestDistance = UINT8_MAX;
+		for (uint16_t j = i; j < count; j++) {
+			uint8_t d = distance(from, pixels[j]);
+			if (d < nearestDistance) {
+				nearestDistance = d;
+				nearest = j;
+				if (d <= 1) break;
+			}
+		}
+		uint16_t next = pixels[nearest];
+		pixels[nearest] = pixels[i];
+		pixels[i] = next;
+		from = next;
+	}
+}
+
+// 2-opt on the open path that starts at `from`: reverses stretches while that shortens it
+static void twoOpt(uint16_t* pixels, uint16_t count, uint16_t from) {
+	for (uint8_t pass = 0; pass < PatternPlanner::TWO_OPT_PASSES; pass++) {
+		bool improved = false;
+		for (uint16_t i = 0; i + 1 < count; i++) {
+			uint16_t before = i == 0 ? from : pixels[i - 1];
+			uint16_t last = i + PatternPlanner::TWO_OPT_WINDOW < count ? i + PatternPlanner::TWO_OPT_WINDOW : count - 1;
+			for (uint16_t j = i + 1; j <= last; j++) {
+				int delta = distance(before, pixels[j]) - distance(before, pixels[i]);
+				if (j + 1 < count) {
+					delta += distance(pixels[i], pixels[j + 1]) - distance(pixels[j], pixels[j + 1]);
+				}
+				if (delta < 0) {
+					for (uint16_t a = i, b = j; a < b; a++, b--) {
+						uint16_t swap = pixels[a];
+						pixels[a] = pixels[b];
+						pixels[b] = swap;
+					}
+					improved = true;
+				}
+			}
+		}
+		if (!improved) break;
+	}
+}
+
+static uint8_t colorAt(const Design::FrameData& frame, uint16_t pixel) {
+	return frame.pixels[pixelY(pixel)][pixelX(pixel)] + 1;
+}
+
+// 4-connected neighbours inside the canvas
+static uint8_t neighbours(uint16_t pixel, uint16_t out[4]) {
+	uint8_t count = 0;
+	if (pixelX(pixel) > 0) out[count++] = pixel - 1;
+	if (pixelX(pixel) < SIZE - 1) out[count++] = pixel + 1;
+	if (pixelY(pixel) > 0) out[count++] = pixel - SIZE;
+	if (pixelY(pixel) < SIZE - 1) out[count++] = pixel + SIZE;
+	return count;
+}
+
+static void segment(const Design::FrameData& frame) {
+	for (uint16_t pixel = 0; pixel < PIXELS; pixel++) regionOf[pixel] = NONE;
+	regionCount = 0;
+
+	for (uint16_t seed = 0; seed < PIXELS; seed++) {
+		if (regionOf[seed] != NONE) continue;
+		uint8_t color = colorAt(frame, seed);
+		uint16_t head = 0;
+		uint16_t tail = 0;
+		queue[tail++] = seed;
+		regionOf[seed] = regionCount;
+		while (head < tail) {
+			uint16_t around[4];
+			uint8_t count = neighbours(queue[head++], around);
+			for (uint8_t i = 0; i < count; i++) {
+				if (regionOf[around[i]] != NONE || colorAt(frame, around[i]) != color) continue;
+				regionOf[around[i]] = regionCount;
+				queue[tail++] = around[i];
+			}
+		}
+		regionColor[regionCount] = color;
+		regionSize[regionCount] = tail;
+		regionCount++;
+	}
+
+	for (uint16_t pixel = 0; pixel < PIXELS; pixel++) {
+		uint16_t around[4];
+		uint8_t count = neighbours(pixel, around);
+		uint16_t colors = 0;
+		for (uint8_t i = 0; i < count; i++) {
+			if (regionOf[around[i]] != regionOf[pixel]) colors |= 1 << colorAt(frame, around[i]);
+		}
+		neighbourColors[pixel] = colors;
+	}
+}
+
+/**
+ * Colour bits of what is still the fill colour when each pass starts: the passes after it, and the fill
+ * colour's own regions, which are never drawn. A border pixel next to any of them has to be penned
+ * before a bucket press, everything drawn earlier already walls the fill in. That is why enclosed
+ * regions are best drawn before whatever surrounds them.
+ */
+static void stillFilled(const uint8_t order[], uint8_t orderCount, uint8_t fill, uint16_t later[]) {
+	uint16_t colors = 1 << fill;
+	for (uint8_t i = orderCount; i > 0; i--) {
+		later[order[i - 1]] = colors;
+		colors |= 1 << order[i - 1];
+	}
+}
+
+static bool sealed(uint16_t pixel, const uint16_t later[]) {
+	return (neighbourColors[pixel] & later[regionColor[regionOf[pixel]]]) != 0;
+}
+
+static void countSeals(uint8_t fill, const uint16_t later[]) {
+	for (uint16_t region = 0; region < regionCount; region++) regionSeal[region] = 0;
+	for (uint16_t pixel = 0; pixel < PIXELS; pixel++) {
+		if (regionColor[regionOf[pixel]] != fill && sealed(pixel, later)) regionSeal[regionOf[pixel]]++;
+	}
+}
+
+// A pixel penned or pressed with the bucket, with the move to it, which is mostly one tap
+static uint32_t pixelPolls(const Weights& weights) {
+	return weights.press + weights.move;
+}
+
+static uint32_t switchPolls(const Weights& weights) {
+	return 2 * PatternPlanner::TOOL_SWITCH.polls(weights);
+}
+
+// Pixels each pass would pen without the bucket, and what the fills marked for it would save
+static void passTotals(uint8_t fill, uint32_t pens[], uint32_t saved[]) {
+	for (uint8_t c = 0; c <= COLORS; c++) {
+		pens[c] = 0;
+		saved[c] = 0;
+	}
+	for (uint16_t region = 0; region < regionCount; region++) {
+		uint8_t color = regionColor[region];
+		if (color == fill) continue;
+		pens[color] += regionSize[region];
+		if (regionFilled[region]) saved[color] += regionSize[region] - regionSeal[region] - regionPresses[region];
+	}
+}
+
+// A pass only uses the bucket if its fills together save more than going to the bucket and back
+static bool worthSwitching(uint32_t saved, const Weights& weights) {
+	return saved * pixelPolls(weights) > switchPolls(weights);
+}
+
+// Polls the passes take in this order over the filled canvas, a bucket press per unsealed region
+static uint32_t estimateOrder(const uint8_t order[], uint8_t orderCount, uint8_t fill, const Weights& weights) {
+	uint16_t later[COLORS + 1] = {};
+	stillFilled(order, orderCount, fill, later);
+	countSeals(fill, later);
+	for (uint16_t region = 0; region < regionCount; region++) {
+		regionPresses[region] = regionSize[region] > regionSeal[region] ? 1 : 0;
+		regionFilled[region] = regionSeal[region] + regionPresses[region] < regionSize[region];
+	}
+	uint32_t pens[COLORS + 1];
+	uint32_t saved[COLORS + 1];
+	passTotals(fill, pens, saved);
+
+	uint32_t polls = 0;
+	uint8_t color = fill;
+	for (uint8_t i = 0; i < orderCount; i++) {
+		uint8_t passColor = order[i];
+		if (worthSwitching(saved[passColor], weights)) {
+			polls += (pens[passColor] - saved[passColor]) * pixelPolls(weights) + switchPolls(weights);
+		} else {
+			polls += pens[passColor] * pixelPolls(weights);
+		}
+		polls += PatternPlanner::colorDistance(color, passColor) * weights.colorStep;
+		color = passColor;
+	}
+	return polls;
+}
+
+static void moveEntry(uint8_t order[], uint8_t from, uint8_t to) {
+	uint8_t entry = order[from];
+	for (; from < to; from++) order[from] = order[from + 1];
+	for (; from > to; from--) order[from] = order[from - 1];
+	order[to] = entry;
+}
+
+// Moves single passes elsewhere in the order while that lowers the estimate, starting from the cheapest sweep
+static void improveOrder(uint8_t order[], uint8_t orderCount, uint8_t fill, const Weights& weights) {
+	uint32_t best = estimateOrder(order, orderCount, fill, weights);
+	for (uint8_t round = 0; round < PatternPlanner::ORDER_ROUNDS; round++) {
+		bool improved = false;
+		for (uint8_t from = 0; from < orderCount; from++) {
+			for (uint8_t to = 0; to < orderCount; to++) {
+				if (to == from) continue;
+				moveEntry(order, from, to);
+				uint32_t cost = estimateOrder(order, orderCount, fill, weights);
+				if (cost < best) {
+					best = cost;
+					improved = true;
+				} else {
+					moveEntry(order, to, from);
+				}
+			}
+		}
+		if (!improved) break;
+	}
+}
+
+/**
+ * Decides the fills for the final order. Sealing can cut what is left of a region into several
+ * parts, each needs its own bucket press, so they are labelled here: pressOf holds the press that
+ * covers a pixel, or NONE where the pixel is penned or left as it is.
+ */
+static void decideFills(uint8_t fill, const uint16_t later[], const Weights& weights) {
+	countSeals(fill, later);
+	for (uint16_t region = 0; region < regionCount; region++) regionPresses[region] = 0;
+
+	uint16_t presses = 0;
+	for (uint16_t pixel = 0; pixel < PIXELS; pixel++) pressOf[pixel] = NONE;
+	for (uint16_t seed = 0; seed < PIXELS; seed++) {
+		uint16_t region = regionOf[seed];
+		if (pressOf[seed] != NONE || regionColor[region] == fill || sealed(seed, later)) continue;
+		uint16_t head = 0;
+		uint16_t tail = 0;
+		queue[tail++] = seed;
+		pressOf[seed] = presses;
+		while (head < tail) {
+			uint16_t around[4];
+			uint8_t count = neighbours(queue[head++], around);
+			for (uint8_t i = 0; i < count; i++) {
+				uint16_t next = around[i];
+				if (pressOf[next] != NONE || regionOf[next] != region || sealed(next, later)) continue;
+				pressOf[next] = presses;
+				queue[tail++] = next;
+			}
+		}
+		regionPresses[region]++;
+		presses++;
+	}
+
+	for (uint16_t region = 0; region < regionCount; region++) {
+		regionFilled[region] = regionSeal[region] + regionPresses[region] < regionSize[region];
+	}
+	uint32_t pens[COLORS + 1];
+	uint32_t saved[COLORS + 1];
+	passTotals(fill, pens, saved);
+	for (uint16_t region = 0; region < regionCount; region++) {
+		if (!worthSwitching(saved[regionColor[region]], weights)) regionFilled[region] = false;
+	}
+}
+
+// Tours the pass's pixels from `cursor` and appends them to the plan with the pen
+static void routePens(uint16_t count, uint8_t color, uint16_t& cursor, PatternPlanner::Plan& out) {
+	nearestNeighbour(passPixels, count, cursor);
+	twoOpt(passPixels, count, cursor);
+
+	for (uint16_t j = 0; j < count; j++) {
+		out.cost.moves += distance(cursor, passPixels[j]);
+		cursor = passPixels[j];
+		out.steps[out.count++] = {pixelX(cursor), pixelY(cursor), color, static_cast<uint16_t>(PatternPlanner::Tool::PEN)};
+	}
+}
+
+/**
+ * Appends one bucket press per part of the pass's filled regions, nearest first. The pass's pixels
+ * are in passPixels; each press lands on the pixel of its part closest to the cursor.
+ */
+static void routePresses(uint16_t count, uint8_t color, uint16_t& cursor, PatternPlanner::Plan& out) {
+	while (count > 0) {
+		uint16_t nearest = 0;
+		for (uint16_t i = 1; i < count; i++) {
+			if (distance(cursor, passPixels[i]) < distance(cursor, passPixels[nearest])) nearest = i;
+		}
+		out.cost.moves += distance(cursor, passPixels[nearest]);
+		cursor = passPixels[nearest];
+		out.steps[out.count++] = {pixelX(cursor), pixelY(cursor), color, static_cast<uint16_t>(PatternPlanner::Tool::BUCKET)};
+		out.regions++;
+
+		// Drop the rest of the part the press covers
+		uint16_t press = pressOf[cursor];
+		uint16_t kept = 0;
+		for (uint16_t i = 0; i < count; i++) {
+			if (pressOf[passPixels[i]] != press) passPixels[kept++] = passPixels[i];
+		}
+		count = kept;
+	}
+}
+
+static bool unchanged(const Design::FrameData& frame, const Design::FrameData* canvas, uint16_t pixel) {
+	return canvas != nullptr && canvas->pixels[pixelY(pixel)][pixelX(pixel)] == frame.pixels[pixelY(pixel)][pixelX(pixel)];
+}
+
+/**
+ * Plans the passes starting with the cursor at (x, y) on `color`. With a `fill` colour the canvas is
+ * filled with it first and its regions are left out, the rest are drawn over it with the pen or
+ * filled with the bucket. Without one, pixels the known `canvas` already shows are left out and the
+ * rest are penned, `counts` holds the pixels per colour that are left.
+ */
+static void route(const Design::FrameData& frame, const Design::FrameData* canvas, const uint16_t counts[],
+				  uint8_t x, uint8_t y, uint8_t color, uint8_t fill, const Weights& weights, PatternPlanner::Plan& out) {
+	uint16_t remaining[COLORS + 1];
+	for (uint8_t c = 0; c <= COLORS; c++) remaining[c] = counts[c];
+
+	out.fillColor = fill;
+	out.count = 0;
+	out.regions = 0;
+	out.cost = {};
+	if (fill != 0) {
+		out.cost.colorSteps = PatternPlanner::colorDistance(color, fill);
+		out.cost.add(PatternPlanner::FULL_FILL);
+		remaining[fill] = 0;
+		color = fill;
+	}
+
+	uint8_t order[COLORS];
+	uint8_t orderCount = 0;
+	orderColors(remaining, color, order, orderCount);
+
+	// Over the filled canvas the order decides which borders need penning before a bucket press
+	uint16_t later[COLORS + 1] = {};
+	if (fill != 0) {
+		segment(frame);
+		improveOrder(order, orderCount, fill, weights);
+		stillFilled(order, orderCount, fill, later);
+		decideFills(fill, later, weights);
+	}
+
+	uint16_t cursor = y * SIZE + x;
+	PatternPlanner::Tool tool = PatternPlanner::Tool::PEN;
+	for (uint8_t i = 0; i < orderCount; i++) {
+		uint8_t passColor = order[i];
+		out.cost.colorSteps += PatternPlanner::colorDistance(color, passColor);
+		color = passColor;
+
+		uint16_t count = 0;
+		for (uint16_t pixel = 0; pixel < PIXELS; pixel++) {
+			if (colorAt(frame, pixel) != passColor) continue;
+			if (fill == 0 && unchanged(frame, canvas, pixel)) continue;
+			if (fill != 0 && regionFilled[regionOf[pixel]] && !sealed(pixel, later)) continue;
+			passPixels[count++] = pixel;
+		}
+		if (count > 0 && tool != PatternPlanner::Tool::PEN) {
+			out.cost.add(PatternPlanner::TOOL_SWITCH);
+			tool = PatternPlanner::Tool::PEN;
+		}
+		routePens(count, passColor, cursor, out);
+
+		if (fill == 0) continue;
+		count = 0;
+		for (uint16_t pixel = 0; pixel < PIXELS; pixel++) {
+			if (colorAt(frame, pixel) == passColor && regionFilled[regionOf[pixel]] && pressOf[pixel] != NONE) {
+				passPixels[count++] = pixel;
+			}
+		}
+		if (count > 0 && tool != PatternPlanner::Tool::BUCKET) {
+			out.cost.add(PatternPlanner::TOOL_SWITCH);
+			tool = PatternPlanner::Tool::BUCKET;
+		}
+		routePresses(count, passColor, cursor, out);
+	}
+	if (tool != PatternPlanner::Tool::PEN) out.cost.add(PatternPlanner::TOOL_SWITCH);
+	out.cost.presses += out.count;
+}
+
+namespace PatternPlanner {
+
+	uint8_t colorDistance(uint8_t from, uint8_t to) {
+		uint8_t down = (to - from + COLORS) % COLORS;
+		uint8_t up = COLORS - down;
+		return down == 0 ? 0 : (down < up ? down : up);
+	}
+
+	uint8_t moveDistance(uint8_t fromX, uint8_t fromY, uint8_t toX, uint8_t toY) {
+		uint8_t dx = fromX > toX ? fromX - toX : toX - fromX;
+		uint8_t dy = fromY > toY ? fromY - toY : toY - fromY;
+		return dx > dy ? dx : dy;
+	}
+
+	Weights weightsFor(const InputTiming& timing) {
+		return {
+			timing.holdPolls + timing.releasePolls,
+			timing.holdPolls + timing.releasePolls,
+			timing.buttonPolls * 2 + timing.releasePolls,
+			timing.buttonPolls + timing.releasePolls
+		};
+	}
+
+	void plan(const Design::FrameData& frame, const Design::FrameData* canvas, uint8_t x, uint8_t y, uint8_t color,
+			  const InputTiming& timing, Plan& out) {
+		uint16_t counts[COLORS + 1] = {};
+		uint16_t changed[COLORS + 1] = {};
+		for (uint16_t pixel = 0; pixel < PIXELS; pixel++) {
+			counts[colorAt(frame, pixel)]++;
+			if (!unchanged(frame, canvas, pixel)) changed[colorAt(frame, pixel)]++;
+		}
+		Weights weights = weightsFor(timing);
+
+		// Off the palette button any C-stick tap lands on colour 1
+		uint8_t offButton = 0;
+		if (color == 0) {
+			color = 1;
+			offButton = 1;
+		}
+
+		route(frame, canvas, changed, x, y, color, 0, weights, out);
+
+		// Filling starts over, which pays off when most of the canvas changes, like on a cut
+		uint8_t dominant = 1;
+		for (uint8_t c = 2; c <= COLORS; c++) {
+			if (counts[c] > counts[dominant]) dominant = c;
+		}
+		route(frame, nullptr, counts, x, y, color, dominant, weights, filledPlan);
+		if (filledPlan.cost.polls(weights) < out.cost.polls(weights)) out = filledPlan;
+		out.cost.colorSteps += offButton;
+
+		out.changed = 0;
+		for (uint8_t c = 1; c <= COLORS; c++) out.changed += changed[c];
+	}
+
+	Cost serpentineCost(const Design::FrameData& frame, uint8_t color) {
+		Cost cost = {PIXELS - 1, 0, PIXELS, 0};
+		for (uint8_t row = 0; row < SIZE; row++) {
+			for (uint8_t i = 0; i < SIZE; i++) {
+				uint8_t col = row % 2 == 0 ? i : SIZE - 1 - i;
+				uint8_t next = frame.pixels[row][col] + 1;
+				cost.colorSteps += colorDistance(color, next);
+				color = next;
+			}
+		}
+		return cost;
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <stdint.h>
+#include "design.hpp"
+#include "types.hpp"
+
+// Plans the order a pattern frame gets drawn in. Pixels are grouped into one pass per colour, so
+// the colour only changes between passes, the passes go round the colour menu in as few C-stick
+// taps as possible, and each pass is routed as a short tour over its pixels with diagonal moves.
+// When it is cheaper, the canvas is first filled with the frame's most common colour through the
+// tool menu, and the frame's 4-connected single-colour regions are then either drawn with the pen
+// or walled in by penning their border and filled with the bucket, whichever the cost model says
+// takes fewer polls. Over a canvas known to hold an earlier frame only the pixels that differ are drawn.
+namespace PatternPlanner {
+	static const uint8_t SIZE = 32;
+	static const uint16_t PIXELS = SIZE * SIZE;
+
+	// Colours 1-15 in the colour menu; it wraps from 15 to 1 and skips the palette button at 0
+	static const uint8_t COLORS = 15;
+
+	// 2-opt only tries reversing stretches of up to this many pixels, and gives up after
+	// TWO_OPT_PASSES rounds, so it tries at most TWO_OPT_PASSES * TWO_OPT_WINDOW reversals per
+	// pixel. How long a frame takes to plan on the Pico has not been measured, the frame report prints it
+	static const uint16_t TWO_OPT_WINDOW = 64;
+	static const uint8_t TWO_OPT_PASSES = 8;
+
+	// Rounds of moving single passes elsewhere in the order while that lowers the estimate
+	static const uint8_t ORDER_ROUNDS = 4;
+
+	// Pen draws one pixel, the bucket fills the 4-connected area of one colour it is pressed in
+	enum class Tool : uint8_t {
+		PEN,
+		BUCKET
+	};
+
+	// Press A at (x, y) with colour menu colour 1-15 and the given tool, packed so a plan of every
+	// pixel takes 2 KB
+	struct Step {
+		uint16_t x : 5;
+		uint16_t y : 5;
+		uint16_t color : 4;
+		uint16_t tool : 1;   // A Tool
+
+		Tool getTool() const { return static_cast<Tool>(tool); }
+	};
+	static_assert(sizeof(Step) == 2, "Step must pack into 16 bits");
+
+	// Polls each kind of input takes, hold plus release, the way design mode times them
+	struct Weights {
+		uint32_t move;
+		uint32_t colorStep;
+		uint32_t press;
+		uint32_t menuButton;
+	};
+
+	Weights weightsFor(const InputTiming& timing);
+
+	// Timed inputs, each followed by a release: stick taps, C-stick taps, A presses and L presses
+	// for the tool menu
+	struct Cost {
+		uint32_t moves;
+		uint32_t colorSteps;
+		uint32_t presses;
+		uint32_t menuButtons;
+
+		uint32_t total() const { return moves + colorSteps + presses + menuButtons; }
+
+		uint32_t polls(const Weights& weights) const {
+			return moves * weights.move + colorSteps * weights.colorStep + presses * weights.press
+				+ menuButtons * weights.menuButton;
+		}
+
+		void add(const Cost& other) {
+			moves += other.moves;
+			colorSteps += other.colorSteps;
+			presses += other.presses;
+			menuButtons += other.menuButtons;
+		}
+	};
+
+	// Tool menu round trip that fills the whole canvas: L, down, right x5, A, A, L, left x5, up, A
+	static const Cost FULL_FILL = {12, 0, 3, 2};
+
+	// Picking the bucket (L, down, A) or the pen again (L, up, A)
+	static const Cost TOOL_SWITCH = {1, 0, 1, 1};
+
+	struct Plan {
+		uint8_t fillColor;   // Colour the canvas is filled with before the steps, 0 for none
+		Step steps[PIXELS];
+		uint16_t count;
+		uint16_t regions;    // Regions filled with the bucket
+		uint16_t changed;    // Pixels that differ from the canvas, all of them if it is unknown
+		Cost cost;           // Including going back to the pen after the last bucket press
+	};
+
+	// C-stick taps between two colours of the colour menu
+	uint8_t colorDistance(uint8_t from, uint8_t to);
+
+	// Stick taps between two pixels, a diagonal tap moves along both axes
+	uint8_t moveDistance(uint8_t fromX, uint8_t fromY, uint8_t toX, uint8_t toY);
+
+	/**
+	 * Plans the frame over `canvas`, what the pattern is known to show, or over an unknown canvas if it
+	 * is nullptr. Starts with the cursor at (x, y) on colour `color` with the pen. Pixels are compared
+	 * by colour index, a palette change does not touch them.
+	 */
+	void plan(const Design::FrameData& frame, const Design::FrameData* canvas, uint8_t x, uint8_t y, uint8_t color,
+			  const InputTiming& timing, Plan& out);
+
+	// What drawing the frame row by row, alternating direction, from (0, 0) costs
+	Cost serpentineCost(const Design::FrameData& frame, uint8_t color);
+}
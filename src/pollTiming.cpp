@@ -0,0 +1,125 @@
+#include "pollTiming.hpp"
+#include "joybus.hpp"
+#include "pico/platform.h"
+
+// Everything recorded on core1 lives in RAM so the joybus loop never waits on flash
+static uint32_t recentIntervals[PollTiming::RING_SIZE];
+static uint32_t lastTimestampUs = 0;
+static uint32_t intervalHistogram[PollTiming::INTERVAL_BINS + 1]; // Last bin counts everything longer
+static uint32_t latencyHistogram[PollTiming::LATENCY_BINS + 1];
+static uint32_t pollCount = 0;
+static uint32_t missedPolls = 0;
+static uint32_t breaks = 0;
+static uint32_t intervalCount = 0;
+static uint64_t intervalTotalUs = 0;
+static uint32_t intervalMinUs = UINT32_MAX;
+static uint32_t intervalMaxUs = 0;
+static uint32_t latencyCount = 0;
+static uint64_t latencyTotalUs = 0;
+static uint32_t latencyMinUs = UINT32_MAX;
+static uint32_t latencyMaxUs = 0;
+
+static uint32_t producerCount = 0;
+static uint64_t producerTotalUs = 0;
+static uint32_t producerMinUs = UINT32_MAX;
+static uint32_t producerMaxUs = 0;
+
+// Smallest value below which 99% of the histogram's samples fall
+static uint32_t percentile99(const uint32_t* histogram, uint32_t bins, uint32_t binWidth, uint32_t total) {
+	if (total == 0) return 0;
+	uint64_t threshold = ((uint64_t)total * 99 + 99) / 100;
+	uint64_t seen = 0;
+	for (uint32_t i = 0; i <= bins; i++) {
+		seen += histogram[i];
+		if (seen >= threshold) return (i + 1) * binWidth;
+	}
+	return (bins + 1) * binWidth;
+}
+
+namespace PollTiming {
+
+	void __time_critical_func(recordPoll)(uint32_t timestampUs, uint32_t replyLatencyUs) {
+		if (pollCount > 0) {
+			uint32_t interval = timestampUs - lastTimestampUs;
+
+			// Once the cadence is known, anything over 1.5 periods means the console skipped polls or
+			// stopped polling, before that anything past the histogram can't be a poll interval
+			bool gap;
+			if (intervalCount >= 16) {
+				uint32_t period = intervalTotalUs / intervalCount;
+				gap = interval > period + period / 2;
+				if (gap && interval <= period * BREAK_PERIODS) {
+					missedPolls += (interval + period / 2) / period - 1;
+				} else if (gap) {
+					breaks++;
+				}
+			} else {
+				gap = interval >= INTERVAL_BINS * INTERVAL_BIN_US;
+				if (gap) breaks++;
+			}
+
+			if (!gap) {
+				uint32_t bin = interval / INTERVAL_BIN_US;
+				intervalHistogram[bin < INTERVAL_BINS ? bin : INTERVAL_BINS]++;
+				recentIntervals[intervalCount % RING_SIZE] = interval;
+				intervalCount++;
+				intervalTotalUs += interval;
+				if (interval < intervalMinUs) intervalMinUs = interval;
+				if (interval > intervalMaxUs) intervalMaxUs = interval;
+			}
+		}
+		lastTimestampUs = timestampUs;
+		pollCount++;
+
+		if (replyLatencyUs != UINT32_MAX) {
+			latencyHistogram[replyLatencyUs < LATENCY_BINS ? replyLatencyUs : LATENCY_BINS]++;
+			latencyCount++;
+			latencyTotalUs += replyLatencyUs;
+			if (replyLatencyUs < latencyMinUs) latencyMinUs = replyLatencyUs;
+			if (replyLatencyUs > latencyMaxUs) latencyMaxUs = replyLatencyUs;
+		}
+	}
+
+	void recordProducerTime(uint32_t durationUs) {
+		producerCount++;
+		producerTotalUs += durationUs;
+		if (durationUs < producerMinUs) producerMinUs = durationUs;
+		if (durationUs > producerMaxUs) producerMaxUs = durationUs;
+	}
+
+	Summary getSummary() {
+		Summary summary = {};
+		summary.polls = pollCount;
+		summary.missedPolls = missedPolls;
+		summary.breaks = breaks;
+		summary.lateReports = getLateReportCount();
+		if (intervalCount > 0) {
+			summary.intervalMinUs = intervalMinUs;
+			summary.intervalAvgUs = intervalTotalUs / intervalCount;
+			summary.intervalMaxUs = intervalMaxUs;
+			summary.intervalP99Us = percentile99(intervalHistogram, INTERVAL_BINS, INTERVAL_BIN_US, intervalCount);
+		}
+		if (latencyCount > 0) {
+			summary.latencyMinUs = latencyMinUs;
+			summary.latencyAvgUs = latencyTotalUs / latencyCount;
+			summary.latencyMaxUs = latencyMaxUs;
+			summary.latencyP99Us = percentile99(latencyHistogram, LATENCY_BINS, 1, latencyCount);
+		}
+		if (producerCount > 0) {
+			summary.producerMinUs = producerMinUs;
+			summary.producerAvgUs = producerTotalUs / producerCount;
+			summary.producerMaxUs = producerMaxUs;
+		}
+		return summary;
+	}
+
+	uint32_t getRecentIntervals(uint32_t* intervalsUs, uint32_t maxCount) {
+		uint32_t recorded = intervalCount;
+		uint32_t available = recorded < RING_SIZE ? recorded : RING_SIZE;
+		uint32_t count = available < maxCount ? available : maxCount;
+		for (uint32_t i = 0; i < count; i++) {
+			intervalsUs[i] = recentIntervals[(recorded - count + i) % RING_SIZE];
+		}
+		return count;
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace PollTiming {
+	// Ring buffer of recent poll intervals
+	static const uint32_t RING_SIZE = 256;
+
+	// A gap of over 1.5 periods means the console skipped polls, one of over BREAK_PERIODS means it
+	// stopped polling for a while (a menu that doesn't read the pad, the time before the game starts).
+	// Neither goes into the interval statistics, the next interval is measured from the poll after it.
+	static const uint32_t BREAK_PERIODS = 4;
+
+	// Interval histogram: 100us bins up to 25.6ms, reply latency histogram: 1us bins up to 64us
+	static const uint32_t INTERVAL_BIN_US = 100;
+	static const uint32_t INTERVAL_BINS = 256;
+	static const uint32_t LATENCY_BINS = 64;
+
+	struct Summary {
+		uint32_t polls;
+		uint32_t missedPolls;       // Polls skipped in gaps of up to BREAK_PERIODS
+		uint32_t breaks;            // Longer gaps, left out of the statistics
+		uint32_t lateReports;       // Polls answered with a stale report because the producer fell behind
+		uint32_t intervalMinUs;
+		uint32_t intervalAvgUs;
+		uint32_t intervalMaxUs;
+		uint32_t intervalP99Us;
+		uint32_t latencyMinUs;
+		uint32_t latencyAvgUs;
+		uint32_t latencyMaxUs;
+		uint32_t latencyP99Us;
+		uint32_t producerMinUs;     // Time spent in getControllerState() on core0
+		uint32_t producerAvgUs;
+		uint32_t producerMaxUs;
+	};
+
+	// Called by the joybus loop on core1 for every answered 0x40 poll (latency is UINT32_MAX if not measured)
+	void recordPoll(uint32_t timestampUs, uint32_t replyLatencyUs);
+
+	// Called on core0 with the time it took to compute a report
+	void recordProducerTime(uint32_t durationUs);
+
+	// Snapshot of the statistics, may be mid-update since core1 keeps writing (diagnostics only)
+	Summary getSummary();
+
+	// Copies up to maxCount of the most recently recorded poll intervals, oldest first, returns how many were copied
+	uint32_t getRecentIntervals(uint32_t* intervalsUs, uint32_t maxCount);
+}
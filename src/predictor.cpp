@@ -0,0 +1,244 @@
+#include "predictor.hpp"
+#include "glyphIndex.hpp"
+#include "bigrams.hpp"
+
+using GlyphIndex::NO_GLYPH;
+
+static const uint32_t LAYER_CELLS = GlyphIndex::ROWS * GlyphIndex::COLS;
+
+// Weights out of 255, or learned counts
+struct Successor {
+	GlyphId glyph;
+	uint8_t weight;
+};
+
+struct PriorTable {
+	Successor next[GlyphIndex::MAX_GLYPHS][Predictor::PRIOR_SUCCESSORS];
+	uint32_t unknownGlyphs;
+};
+
+static constexpr PriorTable makePrior() {
+	PriorTable table = {};
+	for (const Bigrams::Row& row : Bigrams::rows) {
+		GlyphId glyph = GlyphIndex::glyphId(row.glyph);
+		if (glyph == NO_GLYPH) {
+			table.unknownGlyphs++;
+			continue;
+		}
+		for (uint8_t i = 0; i < Predictor::PRIOR_SUCCESSORS && row.next[i].glyph != nullptr; i++) {
+			GlyphId next = GlyphIndex::glyphId(row.next[i].glyph);
+			if (next == NO_GLYPH) {
+				table.unknownGlyphs++;
+				continue;
+			}
+			table.next[glyph][i] = {next, row.next[i].weight};
+		}
+	}
+	return table;
+}
+
+static constexpr PriorTable prior = makePrior();
+static_assert(prior.unknownGlyphs == 0, "bigrams.hpp has a glyph that is not on the keyboard, regenerate it");
+
+// Sum of the moves from a cell to every cell of its layer, for the part of the prior the table leaves out
+struct SpreadTable {
+	uint16_t moves[GlyphIndex::CELL_COUNT];
+};
+
+static constexpr SpreadTable makeSpread() {
+	SpreadTable table = {};
+	for (uint8_t cell = 0; cell < GlyphIndex::CELL_COUNT; cell++) {
+		uint8_t layerStart = cell / LAYER_CELLS * LAYER_CELLS;
+		for (uint8_t other = layerStart; other < layerStart + LAYER_CELLS; other++) {
+			table.moves[cell] += GlyphIndex::costMatrix.costs[cell][other];
+		}
+	}
+	return table;
+}
+
+static constexpr SpreadTable spread = makeSpread();
+
+// Successor counts per (glyph before last, last glyph), direct mapped
+struct LearnedContext {
+	uint16_t context;
+	Successor successors[Predictor::LEARNED_SUCCESSORS];
+};
+
+static LearnedContext learned[Predictor::LEARNED_CONTEXTS] = {};
+
+static GlyphId previous = NO_GLYPH;
+static GlyphId beforePrevious = NO_GLYPH;
+static bool keyboardOpen = false;
+static bool offered = false;
+static bool pending = false;
+static uint8_t originCell = 0;
+static uint8_t restCell = 0;
+static uint32_t missStreak = 0;
+// Off until the user turns it on with Ctrl+P: the keyboard being open is only inferred, and a
+// resting tap sent after the game closed it would move through whatever menu took its place
+static Predictor::Stats stats = {0, 0, 0, 0, false};
+
+static uint16_t contextKey(GlyphId first, GlyphId second) {
+	return (uint16_t)((first << 8) | second);
+}
+
+static LearnedContext& contextSlot(uint16_t key) {
+	return learned[(key * 2654435761u) >> (32 - Predictor::LEARNED_CONTEXT_BITS)];
+}
+
+static void learn(uint16_t key, GlyphId next) {
+	LearnedContext& slot = contextSlot(key);
+	if (slot.context != key) {
+		slot = {};
+		slot.context = key;
+	}
+
+	Successor* weakest = &slot.successors[0];
+	for (Successor& successor : slot.successors) {
+		if (successor.glyph == next) {
+			if (successor.weight == UINT8_MAX) {
+				for (Successor& other : slot.successors) other.weight /= 2;
+			}
+			successor.weight++;
+			return;
+		}
+		if (successor.weight < weakest->weight) weakest = &successor;
+	}
+	*weakest = {next, 1};
+}
+
+// Fewest moves from a cell to anywhere the glyph can be typed
+static uint32_t movesTo(uint8_t cell, GlyphId glyph) {
+	const GlyphIndex::Glyph* entry = GlyphIndex::find(glyph);
+	uint32_t best = UINT32_MAX;
+	if (entry == nullptr) return best;
+	for (uint8_t i = 0; i < entry->count; i++) {
+		uint32_t moves = GlyphIndex::moveCost(cell, entry->cells[i]);
+		if (moves < best) best = moves;
+	}
+	return best;
+}
+
+namespace Predictor {
+
+	void setEnabled(bool enabled) {
+		stats.enabled = enabled;
+		pending = false;
+	}
+
+	bool isEnabled() {
+		return stats.enabled;
+	}
+
+	void observe(GlyphId typed) {
+		if (previous != NO_GLYPH && beforePrevious != NO_GLYPH) {
+			learn(contextKey(beforePrevious, previous), typed);
+		}
+		beforePrevious = previous;
+		previous = typed;
+		keyboardOpen = true;
+		offered = false;
+		if (stats.backoff > 0) stats.backoff--;
+	}
+
+	void reset() {
+		previous = NO_GLYPH;
+		beforePrevious = NO_GLYPH;
+		keyboardOpen = false;
+		pending = false;
+	}
+
+	bool isKeyboardOpen() {
+		return keyboardOpen;
+	}
+
+	bool predictRest(const VirtualKeyboardPos& from, VirtualKeyboardPos& rest) {
+		if (!stats.enabled || !keyboardOpen || offered || stats.backoff > 0 || previous == NO_GLYPH) return false;
+		offered = true;
+
+		Successor candidates[PRIOR_SUCCESSORS + LEARNED_SUCCESSORS];
+		uint32_t weights[PRIOR_SUCCESSORS + LEARNED_SUCCESSORS];
+		uint8_t count = 0;
+		uint32_t priorTotal = 0;
+		for (const Successor& successor : prior.next[previous]) {
+			if (successor.glyph == NO_GLYPH) break;
+			candidates[count] = successor;
+			weights[count++] = successor.weight;
+			priorTotal += successor.weight;
+		}
+		uint32_t remainder = priorTotal < UINT8_MAX ? UINT8_MAX - priorTotal : 0;
+		if (priorTotal == 0) remainder = 0;
+
+		if (beforePrevious != NO_GLYPH) {
+			LearnedContext& slot = contextSlot(contextKey(beforePrevious, previous));
+			if (slot.context == contextKey(beforePrevious, previous)) {
+				for (const Successor& successor : slot.successors) {
+					if (successor.weight == 0) continue;
+					uint8_t i = 0;
+					while (i < count && candidates[i].glyph != successor.glyph) i++;
+					if (i == count) {
+						candidates[count] = successor;
+						weights[count++] = 0;
+					}
+					weights[i] += successor.weight * LEARNED_WEIGHT;
+				}
+			}
+		}
+
+		uint32_t total = remainder;
+		for (uint8_t i = 0; i < count; i++) total += weights[i];
+		if (total == remainder) return false;
+
+		// Expected moves to the next glyph, scaled by the total weight and the layer size
+		uint8_t layerStart = from.layer * LAYER_CELLS;
+		uint8_t fromCell = GlyphIndex::cellIndex(from);
+		uint32_t originCost = 0;
+		uint32_t bestCost = UINT32_MAX;
+		uint8_t bestCell = fromCell;
+		for (uint8_t cell = layerStart; cell < layerStart + LAYER_CELLS; cell++) {
+			uint32_t cost = remainder * spread.moves[cell];
+			for (uint8_t i = 0; i < count; i++) {
+				cost += weights[i] * LAYER_CELLS * movesTo(cell, candidates[i].glyph);
+			}
+			if (cell == fromCell) originCost = cost;
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestCell = cell;
+			}
+		}
+
+		if ((originCost - bestCost) * MIN_GAIN_DIVISOR < total * LAYER_CELLS) return false;
+
+		stats.predictions++;
+		pending = true;
+		originCell = fromCell;
+		restCell = bestCell;
+		rest = GlyphIndex::cellPos(bestCell);
+		return true;
+	}
+
+	void scoreArrival(GlyphId next) {
+		if (!pending) return;
+		pending = false;
+
+		uint32_t fromOrigin = movesTo(originCell, next);
+		uint32_t fromRest = movesTo(restCell, next);
+		if (fromRest < fromOrigin) {
+			stats.hits++;
+			missStreak = 0;
+		} else if (fromRest > fromOrigin) {
+			// Single misses are priced into the expected cost already, a run of them means the statistics do not fit
+			stats.misses++;
+			missStreak++;
+			if (missStreak >= MISSES_BEFORE_BACKOFF) {
+				uint32_t doublings = missStreak - MISSES_BEFORE_BACKOFF;
+				stats.backoff = doublings < 4 ? 2u << doublings : MAX_BACKOFF;
+				if (stats.backoff > MAX_BACKOFF) stats.backoff = MAX_BACKOFF;
+			}
+		}
+	}
+
+	Stats getStats() {
+		return stats;
+	}
+}
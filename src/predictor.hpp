@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include "types.hpp"
+
+// Guesses what comes after the glyph just typed and finds the cell on the current layer the
+// likely successors are cheapest to reach from, so the typing engine can rest the cursor there
+// while the user is still thinking. Statistics are a bigram table in flash (bigrams.hpp) plus
+// trigram counts learned from what actually gets typed.
+namespace Predictor {
+	static const uint8_t PRIOR_SUCCESSORS = 4;
+	static const uint8_t LEARNED_SUCCESSORS = 4;
+	static const uint32_t LEARNED_CONTEXT_BITS = 7;
+	static const uint32_t LEARNED_CONTEXTS = 1u << LEARNED_CONTEXT_BITS;
+
+	// A learned count weighs as much as this many points of the 255 the prior spreads per glyph
+	static const uint32_t LEARNED_WEIGHT = 16;
+
+	// Moving has to save at least this fraction of an input on average
+	static const uint32_t MIN_GAIN_DIVISOR = 2;
+
+	// Frames the controller must be left alone before the cursor is moved on the user's behalf
+	static const uint32_t QUIET_FRAMES = 30;
+
+	// After this many misses in a row predictions pause for 2, 4, 8... typed glyphs, up to MAX_BACKOFF
+	static const uint32_t MISSES_BEFORE_BACKOFF = 3;
+	static const uint32_t MAX_BACKOFF = 16;
+
+	struct Stats {
+		uint32_t predictions;
+		uint32_t hits;      // The next glyph was cheaper to reach from the resting cell
+		uint32_t misses;    // It would have been cheaper from where the cursor was
+		uint32_t backoff;   // Typed glyphs left before predicting again
+		bool enabled;
+	};
+
+	void setEnabled(bool enabled);
+	bool isEnabled();
+
+	// Called for every glyph the engine types, updates the context and the learned counts. The game
+	// tells the controller nothing, so the engine's A press typing a glyph is what marks the keyboard open
+	void observe(GlyphId typed);
+
+	// Forgets the context and takes the keyboard to be closed: Start, or A or B in passthrough that
+	// may have picked OK or left the keyboard. Only the next glyph the engine types opens it again
+	void reset();
+
+	bool isKeyboardOpen();
+
+	/**
+	 * Cell on `from`'s layer to rest on until the next glyph comes in. Returns false if the keyboard
+	 * is not known to be open, there is no prediction for the current context, predictions are backing
+	 * off, or staying put is about as good. At most one resting cell is offered per typed glyph.
+	 */
+	bool predictRest(const VirtualKeyboardPos& from, VirtualKeyboardPos& rest);
+
+	// Called with the next glyph once it arrives, scores the last resting cell against staying put
+	void scoreArrival(GlyphId next);
+
+	Stats getStats();
+}
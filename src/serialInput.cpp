@@ -0,0 +1,246 @@
+#include "serialInput.hpp"
+#include "glyphIndex.hpp"
+#include "display.hpp"
+#include "keymap.hpp"
+#include "predictor.hpp"
+#include "textField.hpp"
+#include "nookCodes.hpp"
+#include "simulatedController.hpp"
+#include "townTunes.hpp"
+#include "design.hpp"
+#include "pico/stdlib.h"
+#include <stdio.h>
+
+extern KeyBuffer keyBuffer;
+
+// Code point being assembled from the byte stream
+static Utf8Char partial = {};
+static uint8_t expected = 0;
+
+// Glyph being assembled from code points, waiting for whatever variation selector or combining mark
+// may still follow. Too many of them to fit in a Utf8Char and it is rejected.
+static Utf8Char cluster = {};
+static bool clustering = false;
+static bool clusterTooLong = false;
+static uint32_t lastByteUs = 0;
+
+// A glyph the key buffer had no room for, typed before anything else is read
+static GlyphId held = GlyphIndex::NO_GLYPH;
+static bool holding = false;
+
+// Replacing the text field: nothing is read until the engine has typed everything before it,
+// then incoming glyphs are matched against the field until the first one that differs
+static bool awaitingIdle = false;
+static bool replacing = false;
+static size_t matched = 0;
+
+static SerialInput::Stats stats = {};
+
+static size_t availableCredits() {
+	size_t promised = stats.outstanding + (holding ? 1 : 0);
+	size_t free = keyBuffer.freeSlots();
+	return free > promised ? free - promised : 0;
+}
+
+static void grantCredits() {
+	size_t credits = availableCredits();
+	stats.outstanding += credits;
+	printf("%c%u\n", SerialInput::CREDIT_GRANT, (unsigned)credits);
+}
+
+// Town tunes reads the keyboard itself and keeps the key buffer out of it, like the physical keyboard
+static bool pushHeld() {
+	if (TownTunes::isInTownTuneMode() || !keyBuffer.tryPush(held)) return false;
+	holding = false;
+	stats.accepted++;
+	return true;
+}
+
+static void reject(const Utf8Char& glyph) {
+	stats.rejected++;
+	putchar(SerialInput::REJECTED);
+	for (uint8_t i = 0; i < glyph.length; i++) {
+		putchar(glyph.bytes[i]);
+	}
+	putchar('\n');
+}
+
+// Erases whatever of the field the replacement did not match, new glyphs then get typed after it
+static void finishReplacing() {
+	size_t erase = TextField::length() - matched;
+	eraseTypedGlyphs(erase);
+	stats.erased += erase;
+	replacing = false;
+	printf("Replaced text field: kept %u, erased %u\n", (unsigned)matched, (unsigned)erase);
+}
+
+static void startReplacing() {
+	awaitingIdle = false;
+	if (!TextField::isKnown() || NookCodes::isInNookCodeMode()) {
+		printf("Text field unknown, typing the text after it\n");
+		return;
+	}
+	replacing = true;
+	matched = 0;
+}
+
+// Every glyph uses up one credit, whether it ends up typed or not
+static void completeGlyph(const Utf8Char& glyph, bool tooLong) {
+	if (stats.outstanding > 0) stats.outstanding--;
+
+	if (glyph.length == 1 && glyph.bytes[0] == '\r') return;
+	if (tooLong) {
+		reject(glyph);
+		return;
+	}
+
+	GlyphId typed = (glyph.length == 1 && glyph.bytes[0] == '\n') ? GlyphIndex::ENTER
+		: (glyph.length == 1 && glyph.bytes[0] == ' ') ? GlyphIndex::SPACE
+		: GlyphIndex::glyphId(glyph);
+	if (GlyphIndex::find(typed) == nullptr) {
+		reject(glyph);
+		return;
+	}
+	if (replacing) {
+		if (matched < TextField::length() && TextField::at(matched) == typed) {
+			matched++;
+			stats.kept++;
+			return;
+		}
+		finishReplacing();
+	}
+	held = typed;
+	holding = true;
+	pushHeld();
+}
+
+static void completeCluster() {
+	if (!clustering) return;
+	clustering = false;
+	completeGlyph(cluster, clusterTooLong);
+}
+
+// Variation selectors U+FE00-U+FE0F and combining marks U+0300-U+036F belong to the code point before them
+static bool extendsGlyph(const Utf8Char& codePoint) {
+	if (codePoint.length == 3) {
+		return codePoint.bytes[0] == 0xEF && codePoint.bytes[1] == 0xB8 && codePoint.bytes[2] <= 0x8F;
+	}
+	return codePoint.length == 2
+		&& (codePoint.bytes[0] == 0xCC || (codePoint.bytes[0] == 0xCD && codePoint.bytes[1] <= 0xAF));
+}
+
+static void completeCodePoint(const Utf8Char& codePoint) {
+	if (clustering && extendsGlyph(codePoint)) {
+		if (cluster.length + codePoint.length > sizeof(cluster.bytes)) {
+			clusterTooLong = true;
+			return;
+		}
+		for (uint8_t i = 0; i < codePoint.length; i++) {
+			cluster.bytes[cluster.length++] = codePoint.bytes[i];
+		}
+		return;
+	}
+	completeCluster();
+	cluster = codePoint;
+	clusterTooLong = false;
+	clustering = true;
+}
+
+static void handleControl(uint8_t byte) {
+	switch (byte) {
+		case SerialInput::CREDIT_REQUEST:
+			stats.streaming = true;
+			grantCredits();
+			break;
+		case SerialInput::END_OF_TEXT:
+			stats.streaming = false;
+			stats.outstanding = 0;
+			if (replacing) finishReplacing();
+			break;
+		case SerialInput::REPLACE_FIELD:
+			awaitingIdle = true;
+			break;
+		case SerialInput::TIMING_INFO:
+			render_timing_info();
+			break;
+		case SerialInput::NEXT_KEYMAP:
+			select_keymap(get_keymap_index() + 1);
+			printf("Keymap: %s\n", get_keymap_name());
+			break;
+		case SerialInput::TOGGLE_PREDICTOR:
+			Predictor::setEnabled(!Predictor::isEnabled());
+			printf("Predictor: %s\n", Predictor::isEnabled() ? "on" : "off");
+			break;
+		case SerialInput::NEXT_RECALIBRATION:
+			Design::nextRecalibrationPolicy();
+			printf("Recalibration: %s\n", Design::getRecalibrationPolicyName());
+			break;
+	}
+}
+
+static bool isControl(uint8_t byte) {
+	return byte < 0x20 && byte != '\n' && byte != '\r';
+}
+
+static void handleByte(uint8_t byte) {
+	bool continuation = (byte & 0xC0) == 0x80;
+
+	// A sequence cut short by something other than a continuation byte is rejected as it is
+	if (expected > 0 && !continuation) {
+		completeCodePoint(partial);
+		expected = 0;
+	}
+
+	if (expected == 0) {
+		if (isControl(byte)) {
+			// Nothing more can belong to the glyph before a control byte
+			completeCluster();
+			handleControl(byte);
+			return;
+		}
+		partial = {};
+		// A stray continuation byte stands on its own
+		expected = continuation ? 1 : Utf8String::getUtf8ByteCount(byte);
+	}
+
+	partial.bytes[partial.length++] = byte;
+	if (partial.length >= expected) {
+		expected = 0;
+		completeCodePoint(partial);
+	}
+}
+
+namespace SerialInput {
+
+	void poll() {
+		// Nothing more is read while a glyph waits for room, USB flow control then holds the host back
+		if (holding && !pushHeld()) return;
+
+		// Nothing else came for a while, so nothing more belongs to the last glyph
+		if (clustering && expected == 0 && time_us_32() - lastByteUs >= GLYPH_WAIT_US) {
+			completeCluster();
+			if (holding) return;
+		}
+
+		// The field is only compared once everything typed before the replacement is in it
+		if (awaitingIdle) {
+			if (!isTypingIdle() || TownTunes::isInTownTuneMode()) return;
+			startReplacing();
+		}
+
+		for (uint32_t i = 0; i < MAX_BYTES_PER_POLL && !holding && !awaitingIdle; i++) {
+			int byte = getchar_timeout_us(0);
+			if (byte == PICO_ERROR_TIMEOUT) break;
+			lastByteUs = time_us_32();
+			handleByte((uint8_t)byte);
+		}
+
+		if (stats.streaming && availableCredits() >= TOP_UP_CREDITS) {
+			grantCredits();
+		}
+	}
+
+	Stats getStats() {
+		return stats;
+	}
+}
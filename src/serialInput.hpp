@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include "types.hpp"
+
+// Feeds UTF-8 text from the USB serial port into the key buffer, so a host can type whole letters
+// and diary entries. Flow control is credit based: the host may only send as many glyphs as the
+// device granted, and every grant is backed by free key buffer slots, so nothing gets dropped.
+// A glyph is a code point together with the variation selectors (U+FE00-U+FE0F) and combining
+// marks (U+0300-U+036F) that follow it, so 🗝️ is one glyph although it is sent as 🗝 and U+FE0F.
+//
+// Host -> device: text, plus the control bytes below
+// Device -> host: "\x06<credits>\n" grants more glyphs, "\x15<glyph>\n" reports a glyph
+// that is not on the virtual keyboard (its credit is consumed but it is not typed)
+//
+// Text sent after REPLACE_FIELD replaces what the in-game text field holds instead of being added
+// to it: glyphs it starts with are kept, the rest is erased with B and only the new tail is typed.
+// The caret is taken to stay at the end of the field, so it comes down to the longest common prefix.
+namespace SerialInput {
+	static const uint8_t END_OF_TEXT = 0x04;     // EOT: host is done, stop granting
+	static const uint8_t CREDIT_REQUEST = 0x05;  // ENQ: host wants credits, starts a stream
+	static const uint8_t CREDIT_GRANT = 0x06;    // ACK: prefixes a grant
+	static const uint8_t REJECTED = 0x15;        // NAK: prefixes a rejected glyph
+	static const uint8_t TIMING_INFO = 0x14;     // Ctrl+T: print the poll timing and key buffer statistics
+	static const uint8_t NEXT_KEYMAP = 0x0B;     // Ctrl+K: switch the physical keyboard to the next keymap
+	static const uint8_t TOGGLE_PREDICTOR = 0x10; // Ctrl+P: turn cursor pre-positioning on or off
+	static const uint8_t NEXT_RECALIBRATION = 0x0C; // Ctrl+L: switch when design mode recalibrates its cursor
+	static const uint8_t REPLACE_FIELD = 0x12;    // DC2: the text up to END_OF_TEXT replaces the text field
+
+	// Bytes read per call, so the main loop keeps producing reports while text streams in
+	static const uint32_t MAX_BYTES_PER_POLL = 64;
+
+	// A glyph is only complete once the next code point shows nothing more belongs to it, or once
+	// nothing else arrived for this long
+	static const uint32_t GLYPH_WAIT_US = 5000;
+
+	// While streaming, credits are topped up unasked once this many slots are free to grant
+	static const size_t TOP_UP_CREDITS = KeyBuffer::BUFFER_SIZE / 4;
+
+	struct Stats {
+		uint32_t accepted;
+		uint32_t rejected;
+		size_t outstanding;  // Granted credits the host has not used yet
+		uint32_t kept;       // Glyphs a replacement found already in the text field
+		uint32_t erased;     // Glyphs a replacement erased from it
+		bool streaming;
+	};
+
+	// Called from the main loop on core0
+	void poll();
+
+	Stats getStats();
+}
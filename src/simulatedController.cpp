@@ -5,6 +5,12 @@
 #include "townTunes.hpp"
 #include "design.hpp"
 #include "snake.hpp"
+#include "joybus.hpp"
+#include "typingPlanner.hpp"
+#include "glyphIndex.hpp"
+#include "cursorTracker.hpp"
+#include "predictor.hpp"
+#include "textField.hpp"
 #include "types.hpp"
 #include <cstdio>
 #include <cstdlib>
@@ -26,12 +32,8 @@ extern uint8_t currentColor;
 std::queue<uint8_t> initialKeyCodeBuffer;
 static std::map<uint8_t, bool> initialKeyState;
 
-bool isEmptyChar(const Utf8Char& c) {
-	return c.length == 0;
-}
-
-Utf8Char getEmptyChar() {
-	return {{0}, 0};
+bool isEmptyChar(GlyphId c) {
+	return c == GlyphIndex::NO_GLYPH;
 }
 
 extern DeviceState device1;
@@ -39,97 +41,88 @@ extern DeviceState device2;
 extern KeyBuffer keyBuffer;
 VirtualKeyboardPos currentPos = {0, 0, 0};
 static VirtualKeyboardPos targetPos = {0, 0, 0};
-extern const char* virtualKeyboard[4][4][10];
-static bool needsBackspace = false;
+// B presses owed for glyphs that are already in the game's text field
+static uint32_t pendingBackspaces = 0;
+// Backspace presses since the last report, pending glyphs are taken back before anything is pressed
+static uint32_t backspaceRequests = 0;
+static bool typingIdle = true;
+// The engine typed on the keyboard since Start last closed it, so an A press on a glyph types that glyph
+static bool keyboardOpen = false;
+
+// Held backspace repeats after this many frames, then every BACKSPACE_REPEAT_FRAMES
+static const uint32_t BACKSPACE_REPEAT_DELAY_FRAMES = 20;
+static const uint32_t BACKSPACE_REPEAT_FRAMES = 4;
 
 SimulatedState simulatedState = {
 	.xStick = 128,
 	.yStick = 128,
-	.hold_duration_us = 17000,
+	.timing = { 1, 2, 2, 2, 14, 20, 60 }, // Until InputTuning has measured the console or loaded its last measurement
 	.keyboard_calibrated = false,
 };
 
-std::vector<VirtualKeyboardPos> findCharacterPositions(const Utf8Char& targetChar) {
-	std::vector<VirtualKeyboardPos> positions;
-	
-	// First look in current layer
-	for (uint8_t row = 0; row < 4; row++) {
-		for (uint8_t col = 0; col < 10; col++) {
-			const char* cellChar = virtualKeyboard[currentPos.layer][row][col];
-			bool match = true;
-			for (size_t i = 0; i < targetChar.length; i++) {
-				if (cellChar[i] != targetChar.bytes[i] || cellChar[i] == 0) {
-					match = false;
-					break;
-				}
-			}
-			if (match && cellChar[targetChar.length] == 0) {
-				positions.push_back({currentPos.layer, row, col});
-				return positions; // Return immediately if found in current layer
-			}
+// D-pad bits for the arrow keys held on an attached keyboard
+static uint8_t readArrowKeyDpad() {
+	uint8_t arrowKeyDpad = 0;
+
+	// Check for arrow key activations in devices
+	if (device1.initialized && device1.is_keyboard) {
+		// Left arrow (0x5C) or Fn+Left (0x08)
+		if (tracker_is_active(&device1.key_tracker, 0x5C) || tracker_is_active(&device1.key_tracker, 0x08)) {
+			arrowKeyDpad |= 0x01; // D-Left
 		}
-	}
-	
-	// If not found in current layer, search all layers
-	for (uint8_t layer = 0; layer < 4; layer++) {
-		if (layer == currentPos.layer) continue; // Skip current layer as we already checked it
-		
-		for (uint8_t row = 0; row < 4; row++) {
-			for (uint8_t col = 0; col < 10; col++) {
-				const char* cellChar = virtualKeyboard[layer][row][col];
-				bool match = true;
-				for (size_t i = 0; i < targetChar.length; i++) {
-					if (cellChar[i] != targetChar.bytes[i] || cellChar[i] == 0) {
-						match = false;
-						break;
-					}
-				}
-				if (match && cellChar[targetChar.length] == 0) {
-					positions.push_back({layer, row, col});
-				}
-			}
+		// Down arrow (0x5D) or Fn+Down (0x09)
+		if (tracker_is_active(&device1.key_tracker, 0x5D) || tracker_is_active(&device1.key_tracker, 0x09)) {
+			arrowKeyDpad |= 0x04; // D-Down
+		}
+		// Up arrow (0x5E) or Fn+Up (0x06)
+		if (tracker_is_active(&device1.key_tracker, 0x5E) || tracker_is_active(&device1.key_tracker, 0x06)) {
+			arrowKeyDpad |= 0x08; // D-Up
+		}
+		// Right arrow (0x5F) or Fn+Right (0x07)
+		if (tracker_is_active(&device1.key_tracker, 0x5F) || tracker_is_active(&device1.key_tracker, 0x07)) {
+			arrowKeyDpad |= 0x02; // D-Right
 		}
 	}
 	
-	return positions;
-}
-
-int calculateDistance(const VirtualKeyboardPos& from, const VirtualKeyboardPos& to) {
-	return abs(to.row - from.row) + abs(to.col - from.col);
-}
-
-VirtualKeyboardPos findClosestPosition(const std::vector<VirtualKeyboardPos>& positions) {
-	if (positions.empty()) return currentPos;
-	
-	VirtualKeyboardPos closest = positions[0];
-	int minDistance = calculateDistance(currentPos, closest);
-	
-	for (const auto& pos : positions) {
-		int distance = calculateDistance(currentPos, pos);
-		if (distance < minDistance) {
-			minDistance = distance;
-			closest = pos;
+	if (device2.initialized && device2.is_keyboard) {
+		// Left arrow (0x5C)
+		if (tracker_is_active(&device2.key_tracker, 0x5C)) {
+			arrowKeyDpad |= 0x01; // D-Left
+		}
+		// Down arrow (0x5D)
+		if (tracker_is_active(&device2.key_tracker, 0x5D)) {
+			arrowKeyDpad |= 0x04; // D-Down
+		}
+		// Up arrow (0x5E)
+		if (tracker_is_active(&device2.key_tracker, 0x5E)) {
+			arrowKeyDpad |= 0x08; // D-Up
+		}
+		// Right arrow (0x5F)
+		if (tracker_is_active(&device2.key_tracker, 0x5F)) {
+			arrowKeyDpad |= 0x02; // D-Right
 		}
 	}
-	
-	return closest;
+	return arrowKeyDpad;
 }
 
-bool isAnalogOutsideDeadzone(uint8_t analogX, uint8_t analogY) {
-	const int DEADZONE = 30;
-	const int CENTER = 128;
-	
-	int deltaX = analogX - CENTER;
-	int deltaY = analogY - CENTER;
-	
-	// Check if outside circular deadzone
-	return (deltaX * deltaX + deltaY * deltaY) > (DEADZONE * DEADZONE);
+// Whether the user is touching anything passthrough would forward
+static bool isUserInputActive(uint8_t buttons1, uint8_t buttons2, uint8_t dpadState,
+							  uint8_t analogX, uint8_t analogY, uint8_t cX, uint8_t cY) {
+	auto deflected = [](uint8_t axis) {
+		int deflection = axis - 128;
+		return deflection > CursorTracker::STICK_DEADZONE || deflection < -CursorTracker::STICK_DEADZONE;
+	};
+	return (buttons1 & 0x1F) || (buttons2 & 0x70) || dpadState || readArrowKeyDpad() ||
+		   deflected(analogX) || deflected(analogY) || deflected(cX) || deflected(cY);
 }
 
 void handlePassthrough(GCReport& report, uint8_t buttons1, uint8_t buttons2, uint8_t dpadState,
 					  uint8_t analogX, uint8_t analogY, uint8_t cX, uint8_t cY) {
 	static bool lastLState = false;
 	static bool lastYState = false;
+	static bool lastAState = false;
+	static bool lastBState = false;
+	static uint32_t bPressPoll = 0;
 	static uint8_t arrowKeyDpad = 0; // Tracks D-Pad state from arrow keys
 
 	// Handle L button state changes
@@ -154,57 +147,44 @@ void handlePassthrough(GCReport& report, uint8_t buttons1, uint8_t buttons2, uin
 	}
 	lastYState = currentYState;
 
-	// Check for analog stick movement outside deadzone
-	if (isAnalogOutsideDeadzone(analogX, analogY)) {
-		simulatedState.keyboard_calibrated = false;
-	}
+	// A and B edit the text field; a held B auto repeats in the game at a rate that is not followed
+	bool currentAState = (buttons1 & 0x01) != 0;
+	bool currentBState = (buttons1 & 0x02) != 0;
 
-	// Check for START button press
-	if (buttons1 & 0x10) { 
-		simulatedState.keyboard_calibrated = false;
+	// Either may have picked OK or left the keyboard, which the game doesn't tell us about
+	if ((currentAState && !lastAState) || (currentBState && !lastBState)) {
+		Predictor::reset();
 	}
 
-	// Handle arrow key inputs from attached keyboard
-	arrowKeyDpad = 0;
-	
-	// Check for arrow key activations in devices
-	if (device1.initialized && device1.is_keyboard) {
-		// Left arrow (0x5C) or Fn+Left (0x08)
-		if (tracker_is_active(&device1.key_tracker, 0x5C) || tracker_is_active(&device1.key_tracker, 0x08)) {
-			arrowKeyDpad |= 0x01; // D-Left
-		}
-		// Down arrow (0x5D) or Fn+Down (0x09)
-		if (tracker_is_active(&device1.key_tracker, 0x5D) || tracker_is_active(&device1.key_tracker, 0x09)) {
-			arrowKeyDpad |= 0x04; // D-Down
-		}
-		// Up arrow (0x5E) or Fn+Up (0x06)
-		if (tracker_is_active(&device1.key_tracker, 0x5E) || tracker_is_active(&device1.key_tracker, 0x06)) {
-			arrowKeyDpad |= 0x08; // D-Up
-		}
-		// Right arrow (0x5F) or Fn+Right (0x07)
-		if (tracker_is_active(&device1.key_tracker, 0x5F) || tracker_is_active(&device1.key_tracker, 0x07)) {
-			arrowKeyDpad |= 0x02; // D-Right
+	// Outside the keyboard A works menus and dialogue, and anything typed there can't be told apart
+	if (currentAState && !lastAState) {
+		if (keyboardOpen && CursorTracker::isExact()) {
+			TextField::commit(GlyphIndex::glyphAt(currentPos));
+		} else {
+			TextField::forget();
 		}
 	}
-	
-	if (device2.initialized && device2.is_keyboard) {
-		// Left arrow (0x5C)
-		if (tracker_is_active(&device2.key_tracker, 0x5C)) {
-			arrowKeyDpad |= 0x01; // D-Left
-		}
-		// Down arrow (0x5D)
-		if (tracker_is_active(&device2.key_tracker, 0x5D)) {
-			arrowKeyDpad |= 0x04; // D-Down
-		}
-		// Up arrow (0x5E)
-		if (tracker_is_active(&device2.key_tracker, 0x5E)) {
-			arrowKeyDpad |= 0x08; // D-Up
-		}
-		// Right arrow (0x5F)
-		if (tracker_is_active(&device2.key_tracker, 0x5F)) {
-			arrowKeyDpad |= 0x02; // D-Right
-		}
+	lastAState = currentAState;
+
+	uint32_t poll = getPollCount();
+	if (currentBState && !lastBState) {
+		TextField::erase();
+		bPressPoll = poll;
+	} else if (currentBState && poll - bPressPoll >= CursorTracker::REPEAT_DELAY_FRAMES * simulatedState.timing.pollsPerFrame) {
+		TextField::forget();
 	}
+	lastBState = currentBState;
+
+	if (buttons1 & 0x10) {
+		keyboardOpen = false;
+		TextField::clear();
+	}
+
+	// Handle arrow key inputs from attached keyboard
+	arrowKeyDpad = readArrowKeyDpad();
+
+	// Follow the cursor through the D-pad, arrow keys and stick, Start loses it
+	CursorTracker::trackPassthrough(dpadState | arrowKeyDpad, analogX, analogY, (buttons1 & 0x10) != 0);
 
 	// Pass through all inputs
 	report.xStick = analogX;
@@ -244,6 +224,7 @@ void processKeyBuffer(GCReport& report, bool bPressed, uint8_t dpadState, uint8_
 		NEUTRAL,
 		MOVING_HORIZONTAL,
 		MOVING_VERTICAL,
+		MOVING_DIAGONAL,
 		PRESSING_A,
 		PRESSING_L,
 		PRESSING_Y,
@@ -253,14 +234,29 @@ void processKeyBuffer(GCReport& report, bool bPressed, uint8_t dpadState, uint8_
 		CLEARING_BUFFER
 	} state = State::IDLE;
 	
-	static absolute_time_t stateStartTime = get_absolute_time();
-	static Utf8Char currentChar = getEmptyChar();
+	static uint32_t stateStartPoll = getPollCount();
+	static GlyphId currentChar = GlyphIndex::NO_GLYPH;
 	// Track last movement direction: 0 = none, 1 = horizontal, 2 = vertical
 	static uint8_t lastMovementDir = 0;
+	static CursorTracker::Reanchor reanchor = {};
+	// Resting the cursor on a predicted cell: taps go out through passthrough one at a time, so the
+	// user's own input always wins and is followed like any other
+	static bool resting = false;
+	static VirtualKeyboardPos restPos = {};
+	static bool restTapHeld = false;
+	static uint32_t restTapPoll = 0;
+	static VirtualKeyboardPos restTapFrom = {};
+	static uint8_t restTapX = 128;
+	static uint8_t restTapY = 128;
+	static uint32_t lastUserInputPoll = 0;
 
 	// Start with neutral state
 	report = defaultGcReport;
 
+	// The modes below read the keyboard themselves, backspace only edits text
+	uint32_t backspaces = backspaceRequests;
+	backspaceRequests = 0;
+
 	// If we're in town tune mode, handle that separately
 	if (TownTunes::isInTownTuneMode()) {
 		// Initialize arrow key d-pad state
@@ -309,14 +305,14 @@ void processKeyBuffer(GCReport& report, bool bPressed, uint8_t dpadState, uint8_
 		
 		// Process the town tune state machine
 		TownTunes::processTownTune(report, xJustPressed, leftJustPressed, rightJustPressed, 
-								  (buttons1 & 0x10) != 0, simulatedState.hold_duration_us);
+								  (buttons1 & 0x10) != 0, simulatedState.timing);
 		return;
 	}
 	
 	// If we're in snake mode, handle that separately
 	if (Snake::isInSnakeMode()) {
 		// Snake::processSnake now handles its own state and reads the shared initialKeyCodeBuffer when needed.
-		Snake::processSnake(report, simulatedState.hold_duration_us);
+		Snake::processSnake(report, simulatedState.timing);
 		// Check if snake is waiting for the physical Start button
 		if (Snake::getCurrentState() == Snake::SnakeState::WAIT_FOR_START) {
 			if (buttons1 & 0x10) { // Check physical Start button
@@ -359,37 +355,159 @@ void processKeyBuffer(GCReport& report, bool bPressed, uint8_t dpadState, uint8_
 			return;
 		}
 		
+		// The controller is not passed through while drawing, touching it asks for the cursor to be recalibrated
+		if (isUserInputActive(buttons1, buttons2, dpadState, analogX, analogY, cX, cY)) {
+			Design::noteUserInput();
+		}
+
 		// Process the design state machine
-		Design::processDesign(report, simulatedState.hold_duration_us);
+		Design::processDesign(report, simulatedState.timing);
 		return;
 	}
 
-	absolute_time_t currentTime = get_absolute_time();
-	int64_t elapsed_us = absolute_time_diff_us(stateStartTime, currentTime);
-	bool stateWillChange = elapsed_us >= simulatedState.hold_duration_us;
-	bool allowPassthrough = (state == State::IDLE && keyBuffer.isEmpty()) & !NookCodes::isInNookCodeMode();
+	// Next input on the way to targetPos: a layer switch, a stick tap or, once there, A
+	auto stepTowardTarget = [&]() {
+		if (currentPos.layer != targetPos.layer) {
+			if ((currentPos.layer <= 1 && targetPos.layer <= 1) ||
+				(currentPos.layer == 0 && targetPos.layer == 1) ||
+				(currentPos.layer == 1 && targetPos.layer == 0)) {
+				return State::PRESSING_L;
+			}
+			return State::PRESSING_Y;
+		} else if (currentPos.col != targetPos.col && currentPos.row != targetPos.row) {
+			return State::MOVING_DIAGONAL;
+		} else if (currentPos.col != targetPos.col) {
+			return State::MOVING_HORIZONTAL;
+		} else if (currentPos.row != targetPos.row) {
+			return State::MOVING_VERTICAL;
+		}
+		return State::PRESSING_A;
+	};
+
+	// Takes the next glyph straight after an A press when nothing else has to happen first, as IDLE would
+	auto takeNextGlyph = [&]() {
+		GlyphId next;
+		if (pendingBackspaces > 0 || NookCodes::isInNookCodeMode() || NookCodes::shouldClearBuffer() ||
+			!CursorTracker::isExact() || !keyBuffer.peek(0, next) ||
+			isKeyCharacter(next) || isFrogCharacter(next) || isPaintCharacter(next) || !keyBuffer.pop(next)) {
+			return false;
+		}
+		Predictor::scoreArrival(next);
+
+		// Already under the cursor, no need to search
+		if (GlyphIndex::glyphAt(currentPos) == next) {
+			targetPos = currentPos;
+		} else if (!TypingPlanner::planNext(currentPos, next, keyBuffer, targetPos)) {
+			return false;
+		}
+		currentChar = next;
+		return true;
+	};
+
+	// Glyphs still waiting to be typed are taken back for free, only committed ones cost a B press
+	for (; backspaces > 0; backspaces--) {
+		GlyphId retracted;
+		if (keyBuffer.retract(retracted)) continue;
+
+		// The glyph on its way is dropped, the cursor finishes its current step and goes idle
+		if (!isEmptyChar(currentChar) && state != State::PRESSING_A && state != State::PROCESSING_CHARACTER) {
+			currentChar = GlyphIndex::NO_GLYPH;
+			continue;
+		}
+
+		// Nothing left to take back in Nook code mode once the item name is empty
+		if (!NookCodes::isInNookCodeMode() || NookCodes::processBackspace()) {
+			pendingBackspaces++;
+		}
+	}
+
+	// NEUTRAL is the release between two inputs, the other states hold a stick tap or a button
+	uint32_t requiredPolls = simulatedState.timing.buttonPolls;
+	if (state == State::NEUTRAL) {
+		requiredPolls = simulatedState.timing.releasePolls;
+	} else if (state == State::CALIBRATING || state == State::MOVING_HORIZONTAL || state == State::MOVING_VERTICAL ||
+			   state == State::MOVING_DIAGONAL) {
+		requiredPolls = simulatedState.timing.holdPolls;
+	}
+	uint32_t currentPoll = getPollCount();
+	bool stateWillChange = currentPoll - stateStartPoll >= requiredPolls;
+	typingIdle = state == State::IDLE && isEmptyChar(currentChar) && keyBuffer.isEmpty() && pendingBackspaces == 0;
+	bool userInputActive = isUserInputActive(buttons1, buttons2, dpadState, analogX, analogY, cX, cY);
+	if (userInputActive) {
+		lastUserInputPoll = currentPoll;
+	}
+
+	// A resting tap is held to the end even if a glyph comes in, so the game surely sees it
+	bool restTapInProgress = restTapHeld && currentPoll - restTapPoll < simulatedState.timing.holdPolls;
+	bool allowPassthrough = (typingIdle || (restTapInProgress && !userInputActive)) && !NookCodes::isInNookCodeMode();
 
 	// Handle passthrough mode
 	if (allowPassthrough) {
+		if (userInputActive) {
+			if (restTapInProgress) {
+				// Cut short, the game may not have read it
+				CursorTracker::mayStillBeAt(restTapFrom);
+			}
+			resting = false;
+			restTapHeld = false;
+		} else if (resting) {
+			if (restTapHeld && !restTapInProgress) {
+				restTapHeld = false;
+				restTapPoll = currentPoll;
+			}
+			// Checked before every tap, never after it: stop once there or once the keyboard may be gone
+			if (!restTapHeld && currentPoll - restTapPoll >= simulatedState.timing.releasePolls) {
+				if (!typingIdle || !Predictor::isKeyboardOpen() || !CursorTracker::isExact() || currentPos == restPos) {
+					resting = false;
+				} else {
+					restTapHeld = true;
+					restTapPoll = currentPoll;
+					restTapFrom = currentPos;
+					restTapX = restPos.col > currentPos.col ? 255 : restPos.col < currentPos.col ? 0 : 128;
+					restTapY = restPos.row > currentPos.row ? 0 : restPos.row < currentPos.row ? 255 : 128;
+				}
+			}
+		} else {
+			// Only once the controller has been left alone for a while does the cursor move on its own
+			uint32_t quietPolls = Predictor::QUIET_FRAMES * simulatedState.timing.pollsPerFrame;
+			if (typingIdle && currentPoll - lastUserInputPoll >= quietPolls && CursorTracker::isExact() &&
+				Predictor::predictRest(currentPos, restPos)) {
+				resting = true;
+				restTapPoll = currentPoll - simulatedState.timing.releasePolls;
+			}
+		}
+
+		// The tap goes through passthrough like the user's own stick, so the tracker follows it
+		if (restTapHeld) {
+			analogX = restTapX;
+			analogY = restTapY;
+		}
 		handlePassthrough(report, buttons1, buttons2, dpadState, analogX, analogY, cX, cY);
 		return;
 	}
+	if (restTapInProgress) {
+		CursorTracker::mayStillBeAt(restTapFrom);
+	}
+	resting = false;
+	restTapHeld = false;
 
 	switch (state) {
 		case State::IDLE: {
-			if (needsBackspace) {
+			if (pendingBackspaces > 0) {
 				state = State::PRESSING_B;
-				stateStartTime = currentTime;
+				stateStartPoll = currentPoll;
 				break;
 			}
 			
 			if (NookCodes::shouldClearBuffer()) {
 				state = State::CLEARING_BUFFER;
-				stateStartTime = currentTime;
+				stateStartPoll = currentPoll;
 				break;
 			}
 			
 			if (isEmptyChar(currentChar) && keyBuffer.pop(currentChar)) {
+				Predictor::scoreArrival(currentChar);
+
 				if (isKeyCharacter(currentChar)) {
 					if (NookCodes::isInNookCodeMode()) {
 						// Exit nook code mode
@@ -399,69 +517,69 @@ void processKeyBuffer(GCReport& report, bool bPressed, uint8_t dpadState, uint8_
 						NookCodes::enterNookCodeMode();
 						state = State::CLEARING_BUFFER;
 					}
-					stateStartTime = currentTime;
-					currentChar = getEmptyChar();
+					stateStartPoll = currentPoll;
+					currentChar = GlyphIndex::NO_GLYPH;
 					break;
 				}
 				
 				if (isFrogCharacter(currentChar)) {
 					// Enter town tune mode
 					TownTunes::enterTownTuneMode();
-					currentChar = getEmptyChar();
+					currentChar = GlyphIndex::NO_GLYPH;
 					break;
 				}
 				
 				if (isPaintCharacter(currentChar)) {
 					// Enter design mode
 					Design::enterDesignMode();
-					currentChar = getEmptyChar();
+					currentChar = GlyphIndex::NO_GLYPH;
 					break;
 				}
 				
-				if (!simulatedState.keyboard_calibrated) {
+				if (!CursorTracker::isExact()) {
+					// Only push into the edges of the axes that were lost
+					reanchor = CursorTracker::planReanchor(currentChar);
+					KeyboardCalibration::plan(reanchor.colStep < 0 ? KeyboardCalibration::LEFT : KeyboardCalibration::RIGHT, reanchor.colTaps,
+											  reanchor.rowStep < 0 ? KeyboardCalibration::UP : KeyboardCalibration::DOWN, reanchor.rowTaps);
 					state = State::CALIBRATING;
-					KeyboardCalibration::reset();
 					lastMovementDir = 0;  // Reset direction tracking
-					stateStartTime = currentTime;
+					stateStartPoll = currentPoll;
 					break;
 				}
 				
-				auto positions = findCharacterPositions(currentChar);
-				if (!positions.empty()) {
-					targetPos = findClosestPosition(positions);
+				if (TypingPlanner::planNext(currentPos, currentChar, keyBuffer, targetPos)) {
 					state = State::NEUTRAL;
-					stateStartTime = currentTime;
+					stateStartPoll = currentPoll;
 				} else {
-					currentChar = getEmptyChar();
+					currentChar = GlyphIndex::NO_GLYPH;
 				}
 			}
 			break;
 		}
 
 		case State::CALIBRATING: {
-			auto currentMove = KeyboardCalibration::getCurrentMove();
-			report.xStick = currentMove.xStick;
-			report.yStick = currentMove.yStick;
+			if (!KeyboardCalibration::isComplete()) {
+				auto currentMove = KeyboardCalibration::getCurrentMove();
+				report.xStick = currentMove.xStick;
+				report.yStick = currentMove.yStick;
+				
+				if (stateWillChange) {
+					KeyboardCalibration::advance();
+					stateStartPoll = currentPoll;
+				}
+			}
 			
-			if (stateWillChange) {
-				KeyboardCalibration::advance();
-				if (KeyboardCalibration::isComplete()) {
-					currentPos = {0, 0, 0};
-					simulatedState.keyboard_calibrated = true;
-					lastMovementDir = 0;  // Reset direction tracking after calibration
-					
-					if (!isEmptyChar(currentChar)) {
-						auto positions = findCharacterPositions(currentChar);
-						if (!positions.empty()) {
-							targetPos = findClosestPosition(positions);
-						}
-					}
-					
-					state = State::NEUTRAL;
-					stateStartTime = currentTime;
-				} else {
-					stateStartTime = currentTime;
+			// Also taken straight away when only the layer had to be re-established
+			if (KeyboardCalibration::isComplete()) {
+				CursorTracker::completeReanchor(reanchor);
+				lastMovementDir = 0;  // Reset direction tracking after calibration
+				
+				if (!isEmptyChar(currentChar)) {
+					TypingPlanner::planNext(currentPos, currentChar, keyBuffer, targetPos);
 				}
+				
+				state = State::NEUTRAL;
+				stateStartPoll = currentPoll;
 			}
 			break;
 		}
@@ -470,28 +588,14 @@ void processKeyBuffer(GCReport& report, bool bPressed, uint8_t dpadState, uint8_
 			if (stateWillChange) {
 				if (NookCodes::shouldPressStart() && keyBuffer.isEmpty() && isEmptyChar(currentChar)) {
 					state = State::PRESSING_START;
-					stateStartTime = currentTime;
+					stateStartPoll = currentPoll;
 					NookCodes::clearNeedToPressStart();
 				} else if (!isEmptyChar(currentChar)) {
-					if (currentPos.layer != targetPos.layer) {
-						if ((currentPos.layer <= 1 && targetPos.layer <= 1) ||
-							(currentPos.layer == 0 && targetPos.layer == 1) ||
-							(currentPos.layer == 1 && targetPos.layer == 0)) {
-							state = State::PRESSING_L;
-						} else {
-							state = State::PRESSING_Y;
-						}
-					} else if (currentPos.col != targetPos.col) {
-						state = State::MOVING_HORIZONTAL;
-					} else if (currentPos.row != targetPos.row) {
-						state = State::MOVING_VERTICAL;
-					} else {
-						state = State::PRESSING_A;
-					}
+					state = stepTowardTarget();
 				} else {
 					state = State::IDLE;
 				}
-				stateStartTime = currentTime;
+				stateStartPoll = currentPoll;
 			}
 			break;
 		}
@@ -515,10 +619,11 @@ void processKeyBuffer(GCReport& report, bool bPressed, uint8_t dpadState, uint8_
 				} else if (currentPos.row != targetPos.row) {
 					state = State::MOVING_VERTICAL;
 				} else {
-					state = State::PRESSING_A;
+					// Nothing to type when the glyph was taken back
+					state = isEmptyChar(currentChar) ? State::NEUTRAL : State::PRESSING_A;
 				}
 				lastMovementDir = 1;
-				stateStartTime = currentTime;
+				stateStartPoll = currentPoll;
 			}
 			break;
 		}
@@ -542,10 +647,32 @@ void processKeyBuffer(GCReport& report, bool bPressed, uint8_t dpadState, uint8_
 				} else if (currentPos.col != targetPos.col) {
 					state = State::MOVING_HORIZONTAL;
 				} else {
-					state = State::PRESSING_A;
+					state = isEmptyChar(currentChar) ? State::NEUTRAL : State::PRESSING_A;
 				}
 				lastMovementDir = 2;
-				stateStartTime = currentTime;
+				stateStartPoll = currentPoll;
+			}
+			break;
+		}
+
+		case State::MOVING_DIAGONAL: {
+			report.xStick = (currentPos.col < targetPos.col) ? 255 : 0;
+			report.yStick = (currentPos.row < targetPos.row) ? 0 : 255;
+			
+			if (stateWillChange) {
+				if (currentPos.col < targetPos.col) currentPos.col++;
+				else currentPos.col--;
+				if (currentPos.row < targetPos.row) currentPos.row++;
+				else currentPos.row--;
+				
+				// Both axes were held, so any further step needs the stick back in neutral first
+				if (currentPos.col == targetPos.col && currentPos.row == targetPos.row && !isEmptyChar(currentChar)) {
+					state = State::PRESSING_A;
+				} else {
+					state = State::NEUTRAL;
+				}
+				lastMovementDir = 0;
+				stateStartPoll = currentPoll;
 			}
 			break;
 		}
@@ -553,23 +680,38 @@ void processKeyBuffer(GCReport& report, bool bPressed, uint8_t dpadState, uint8_
 		case State::PRESSING_A: {
 			auto& itemName = NookCodes::getItemName();
 			bool nookCodeModeActive = NookCodes::isInNookCodeMode();
+			bool typing = !nookCodeModeActive || (nookCodeModeActive && itemName.size() < 28);
 			
-			if (!nookCodeModeActive || (nookCodeModeActive && itemName.size() < 28)) {
+			if (typing) {
 				report.a = 1;
 			}
 		
 			if (stateWillChange) {
+				Predictor::observe(currentChar);
+				if (typing) {
+					keyboardOpen = true;
+					TextField::commit(currentChar);
+				}
 				if (nookCodeModeActive && itemName.size() < 28) {
 					// Only go to PROCESSING_CHARACTER if we're in nook code mode and need to process
 					NookCodes::addCharToItemName(currentChar);
 					state = State::PROCESSING_CHARACTER;
 				} else {
 					// Otherwise, handle normally
-					currentChar = getEmptyChar(); // Reset direction tracking after completing a character
+					currentChar = GlyphIndex::NO_GLYPH; // Reset direction tracking after completing a character
 					lastMovementDir = 0;
 					state = State::NEUTRAL;
+
+					// The stick is already centred, so a tap can start as A is let go; a second A or
+					// a layer switch still needs the release in between
+					if (takeNextGlyph()) {
+						State step = stepTowardTarget();
+						if (step == State::MOVING_HORIZONTAL || step == State::MOVING_VERTICAL || step == State::MOVING_DIAGONAL) {
+							state = step;
+						}
+					}
 				}
-				stateStartTime = currentTime;
+				stateStartPoll = currentPoll;
 			}
 			break;
 		}
@@ -577,10 +719,10 @@ void processKeyBuffer(GCReport& report, bool bPressed, uint8_t dpadState, uint8_
 		case State::PROCESSING_CHARACTER: {
 			// Process the nook code matching without affecting button timing
 			NookCodes::checkAndProcessNookCode();
-			currentChar = getEmptyChar();
+			currentChar = GlyphIndex::NO_GLYPH;
 			lastMovementDir = 0;
 			state = State::NEUTRAL;
-			stateStartTime = currentTime;
+			stateStartPoll = currentPoll;
 			break;
 		}
 
@@ -590,7 +732,7 @@ void processKeyBuffer(GCReport& report, bool bPressed, uint8_t dpadState, uint8_
 			if (stateWillChange) {
 				currentPos.layer = (currentPos.layer == 0) ? 1 : 0;
 				state = State::NEUTRAL;
-				stateStartTime = currentTime;
+				stateStartPoll = currentPoll;
 			}
 			break;
 		}
@@ -602,7 +744,7 @@ void processKeyBuffer(GCReport& report, bool bPressed, uint8_t dpadState, uint8_
 				else if (currentPos.layer == 2) currentPos.layer = 3;
 				else currentPos.layer = 0;
 				state = State::NEUTRAL;
-				stateStartTime = currentTime;
+				stateStartPoll = currentPoll;
 			}
 			break;
 		}
@@ -610,9 +752,10 @@ void processKeyBuffer(GCReport& report, bool bPressed, uint8_t dpadState, uint8_
 		case State::PRESSING_B: {
 			report.b = 1;
 			if (stateWillChange) {
-				needsBackspace = false;
+				pendingBackspaces--;
+				TextField::erase();
 				state = State::NEUTRAL;
-				stateStartTime = currentTime;
+				stateStartPoll = currentPoll;
 			}
 			break;
 		}
@@ -621,8 +764,10 @@ void processKeyBuffer(GCReport& report, bool bPressed, uint8_t dpadState, uint8_
 			report.start = 1;
 			if (stateWillChange) {
 				state = State::NEUTRAL;
-				simulatedState.keyboard_calibrated = false;
-				stateStartTime = currentTime;
+				CursorTracker::lose();
+				keyboardOpen = false;
+				TextField::clear();
+				stateStartPoll = currentPoll;
 			}
 			break;
 		}
@@ -645,19 +790,45 @@ void processKeyBuffer(GCReport& report, bool bPressed, uint8_t dpadState, uint8_
 				
 				if (clearCount >= 28) {
 					clearCount = 0;
+					TextField::clear();
 					NookCodes::clearNeedToClearBuffer();
 					state = State::NEUTRAL;
 				}
-				stateStartTime = currentTime;
+				stateStartPoll = currentPoll;
 			}
 			break;
 		}
 	}
 }
 
+bool isTypingIdle() {
+	return typingIdle;
+}
+
+void eraseTypedGlyphs(uint32_t count) {
+	pendingBackspaces += count;
+}
+
+// Counts backspace presses, repeating while held once the previous ones have been dealt with
+static void trackBackspace(bool held) {
+	static bool lastHeld = false;
+	static uint32_t nextRepeatPoll = 0;
+	uint32_t poll = getPollCount();
+	uint32_t pollsPerFrame = simulatedState.timing.pollsPerFrame;
+
+	if (held && !lastHeld) {
+		backspaceRequests++;
+		nextRepeatPoll = poll + BACKSPACE_REPEAT_DELAY_FRAMES * pollsPerFrame;
+	} else if (held && (int32_t)(poll - nextRepeatPoll) >= 0 && backspaceRequests == 0 && pendingBackspaces == 0) {
+		backspaceRequests++;
+		nextRepeatPoll = poll + BACKSPACE_REPEAT_FRAMES * pollsPerFrame;
+	}
+	lastHeld = held;
+}
+
 GCReport getControllerState() {
 	GCReport report = defaultGcReport;
-	
+
 	uint8_t dpadState = 0;
 	uint8_t buttons1 = 0;  // byte 0 buttons (A, B, X, Y, Start)
 	uint8_t buttons2 = 0;  // byte 1 buttons (Z, L, R, etc)
@@ -666,23 +837,12 @@ GCReport getControllerState() {
 	uint8_t cX = 128;
 	uint8_t cY = 128;
 	
-	static bool last_backspace = false;
+	bool backspaceHeld = false;
 	
 	// Handle device 1
 	if (device1.initialized) {
 		if (device1.is_keyboard) {
-			if (NookCodes::isInNookCodeMode()) {
-				// Edge detection - only trigger on press, not hold
-				if (device1.backspace_held && !last_backspace) {
-					if (NookCodes::processBackspace()) {
-						needsBackspace = true;
-					}
-				}
-				last_backspace = device1.backspace_held;
-			} else {
-				// Normal behavior - holding backspace sends held B button
-				buttons1 |= device1.backspace_held ? 0x02 : 0;
-			}
+			backspaceHeld |= device1.backspace_held;
 		} else {
 			buttons1 |= device1.last_state[0];  // All buttons from byte 0
 			buttons2 |= device1.last_state[1];  // All buttons from byte 1
@@ -697,18 +857,7 @@ GCReport getControllerState() {
 	// Handle device 2
 	if (device2.initialized) {
 		if (device2.is_keyboard) {
-			if (NookCodes::isInNookCodeMode()) {
-				// Edge detection - only trigger on press, not hold
-				if (device2.backspace_held && !last_backspace) {
-					if (NookCodes::processBackspace()) {
-						needsBackspace = true;
-					}
-				}
-				last_backspace = device2.backspace_held;
-			} else {
-				// Normal behavior - holding backspace sends held B button
-				buttons1 |= device2.backspace_held ? 0x02 : 0;
-			}
+			backspaceHeld |= device2.backspace_held;
 		} else {
 			buttons1 |= device2.last_state[0];  // All buttons from byte 0
 			buttons2 |= device2.last_state[1];  // All buttons from byte 1
@@ -723,6 +872,8 @@ GCReport getControllerState() {
 		}
 	}
 
+	trackBackspace(backspaceHeld);
+
 	if (Snake::isExpectingInitials()) {
 		// Scan keycodes A-Z (0x10 to 0x29)
 		for (uint8_t kc = 0x10; kc <= 0x29; ++kc) {
@@ -7,14 +7,11 @@
 void processKeyBuffer(GCReport& report, bool bPressed, uint8_t dpadState, uint8_t buttons1, uint8_t buttons2,
 					 uint8_t analogX, uint8_t analogY, uint8_t cX, uint8_t cY);
 
-// Find all positions of a character on the virtual keyboard
-std::vector<VirtualKeyboardPos> findCharacterPositions(char targetChar);
-
-// Find the closest position to current position from a list of positions
-VirtualKeyboardPos findClosestPosition(const std::vector<VirtualKeyboardPos>& positions);
-
 // Get the final state of the simulated controller
 GCReport getControllerState();
 
-// Calculate distance between two positions on virtual keyboard
-int calculateDistance(const VirtualKeyboardPos& from, const VirtualKeyboardPos& to);
\ No newline at end of file
+// Whether everything handed to the typing engine has been typed and the cursor is at rest
+bool isTypingIdle();
+
+// Presses B for this many glyphs already in the text field, before anything in the key buffer gets typed
+void eraseTypedGlyphs(uint32_t count);
@@ -2,6 +2,7 @@
 #include "simulatedController.hpp"
 #include "types.hpp"
 #include "gcReport.hpp"
+#include "joybus.hpp"
 #include <cstdlib> // For abs(), random functions
 #include <pico/stdlib.h>
 #include <queue>
@@ -36,8 +37,9 @@ static uint8_t currentColor; // Position in the color menu (0 = button, 1-15 = c
 // Queue for cursor movement commands
 static std::queue<Snake::SnakeState> movementQueue;
 
-// Static variable for state timer
-static absolute_time_t stateStartTime = 0;
+// Static variables for state timer, counted in console polls
+static uint32_t stateStartPoll = 0;
+static bool stateTimerStarted = false;
 
 // Snake game state
 static std::deque<Snake::Position> snakeSegments;
@@ -405,7 +407,7 @@ namespace Snake {
 		movementQueue.push(SnakeState::PRESS_A_BUTTON);
 		initializeGameState();
 		snakeState = SnakeState::WAITING;
-		stateStartTime = get_absolute_time();
+		stateStartPoll = getPollCount();
 	}
 
 	void enterSnakeMode(uint8_t initialPalette, uint8_t initialColor, int x, int y) {
@@ -420,7 +422,7 @@ namespace Snake {
 		while (!initialKeyCodeBuffer.empty()) { initialKeyCodeBuffer.pop(); } // Clear initials buffer
 		initSnake();
 		snakeState = SnakeState::NEUTRAL;
-		stateStartTime = get_absolute_time();
+		stateStartPoll = getPollCount();
 		srand(to_ms_since_boot(get_absolute_time()));
 	}
 
@@ -445,18 +447,19 @@ namespace Snake {
 		}
 	}
 
-	void processSnake(GCReport& report, uint64_t hold_duration_us) {
+	void processSnake(GCReport& report, const InputTiming& timing) {
+		uint32_t currentPoll = getPollCount();
 		if (!inSnakeMode) {
-			 stateStartTime = 0;
+			 stateTimerStarted = false;
 			 report = defaultGcReport;
 			 return;
 		}
-		if (stateStartTime == 0) {
-			stateStartTime = get_absolute_time();
+		if (!stateTimerStarted) {
+			stateStartPoll = currentPoll;
+			stateTimerStarted = true;
 		}
 
-		absolute_time_t currentTime = get_absolute_time();
-		int64_t elapsed_us = absolute_time_diff_us(stateStartTime, currentTime);
+		uint32_t elapsedPolls = currentPoll - stateStartPoll;
 
 		report = defaultGcReport;
 		bool stateWillChange = false;
@@ -469,13 +472,13 @@ namespace Snake {
 			case SnakeState::C_STICK_UP:
 			case SnakeState::C_STICK_DOWN:
 			case SnakeState::NEUTRAL:
-				stateWillChange = elapsed_us >= (hold_duration_us * 2);
+				stateWillChange = elapsedPolls >= (timing.buttonPolls * 2);
 				break;
 			case SnakeState::WAIT_FOR_START:
 				stateWillChange = false;
 				break;
 			default: // Includes WAITING, MOVE_*
-				stateWillChange = elapsed_us >= hold_duration_us;
+				stateWillChange = elapsedPolls >= timing.holdPolls;
 				break;
 		}
 
@@ -487,25 +490,25 @@ namespace Snake {
 
 
 		switch (snakeState) {
-			case SnakeState::PRESS_R_BUTTON: report.r = 1; report.analogR = 255; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartTime = currentTime; } break;
-			case SnakeState::PRESS_L_BUTTON: report.l = 1; report.analogL = 255; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartTime = currentTime; } break;
-			case SnakeState::MOVE_CURSOR_UP: report.yStick = 255; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartTime = currentTime; } break;
-			case SnakeState::MOVE_CURSOR_DOWN: report.yStick = 0; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartTime = currentTime; } break;
-			case SnakeState::MOVE_CURSOR_LEFT: report.xStick = 0; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartTime = currentTime; } break;
-			case SnakeState::MOVE_CURSOR_RIGHT: report.xStick = 255; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartTime = currentTime; } break;
-			case SnakeState::MOVE_CURSOR_UP_LEFT: report.xStick = 0; report.yStick = 255; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartTime = currentTime; } break;
-			case SnakeState::MOVE_CURSOR_UP_RIGHT: report.xStick = 255; report.yStick = 255; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartTime = currentTime; } break;
-			case SnakeState::MOVE_CURSOR_DOWN_LEFT: report.xStick = 0; report.yStick = 0; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartTime = currentTime; } break;
-			case SnakeState::MOVE_CURSOR_DOWN_RIGHT: report.xStick = 255; report.yStick = 0; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartTime = currentTime; } break;
-			case SnakeState::PRESS_A_BUTTON: report.a = 1; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartTime = currentTime; } break; // Uses longer time check
-			case SnakeState::C_STICK_UP: report.cyStick = 255; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartTime = currentTime; } break; // Uses longer time check
-			case SnakeState::C_STICK_DOWN: report.cyStick = 0; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartTime = currentTime; } break; // Uses longer time check
+			case SnakeState::PRESS_R_BUTTON: report.r = 1; report.analogR = 255; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartPoll = currentPoll; } break;
+			case SnakeState::PRESS_L_BUTTON: report.l = 1; report.analogL = 255; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartPoll = currentPoll; } break;
+			case SnakeState::MOVE_CURSOR_UP: report.yStick = 255; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartPoll = currentPoll; } break;
+			case SnakeState::MOVE_CURSOR_DOWN: report.yStick = 0; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartPoll = currentPoll; } break;
+			case SnakeState::MOVE_CURSOR_LEFT: report.xStick = 0; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartPoll = currentPoll; } break;
+			case SnakeState::MOVE_CURSOR_RIGHT: report.xStick = 255; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartPoll = currentPoll; } break;
+			case SnakeState::MOVE_CURSOR_UP_LEFT: report.xStick = 0; report.yStick = 255; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartPoll = currentPoll; } break;
+			case SnakeState::MOVE_CURSOR_UP_RIGHT: report.xStick = 255; report.yStick = 255; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartPoll = currentPoll; } break;
+			case SnakeState::MOVE_CURSOR_DOWN_LEFT: report.xStick = 0; report.yStick = 0; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartPoll = currentPoll; } break;
+			case SnakeState::MOVE_CURSOR_DOWN_RIGHT: report.xStick = 255; report.yStick = 0; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartPoll = currentPoll; } break;
+			case SnakeState::PRESS_A_BUTTON: report.a = 1; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartPoll = currentPoll; } break; // Uses longer time check
+			case SnakeState::C_STICK_UP: report.cyStick = 255; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartPoll = currentPoll; } break; // Uses longer time check
+			case SnakeState::C_STICK_DOWN: report.cyStick = 0; if (stateWillChange) { snakeState = SnakeState::NEUTRAL; stateStartPoll = currentPoll; } break; // Uses longer time check
 
 			case SnakeState::NEUTRAL:
 				// Provide a short delay between actions
-				if (elapsed_us >= hold_duration_us) {
+				if (elapsedPolls >= timing.releasePolls) {
 					snakeState = SnakeState::WAITING;
-					stateStartTime = currentTime;
+					stateStartPoll = currentPoll;
 				}
 				break;
 
@@ -514,7 +517,7 @@ namespace Snake {
 				if (!movementQueue.empty()) {
 					snakeState = movementQueue.front();
 					movementQueue.pop();
-					stateStartTime = get_absolute_time(); // Reset timer for the new action
+					stateStartPoll = getPollCount(); // Reset timer for the new action
 				}
 				// If action queue is empty, check game state and initial buffer
 				else {
@@ -534,7 +537,7 @@ namespace Snake {
 								initialKeyCodeBuffer.pop();
 								queueInitialDrawing(nextInitialKc); // Queues drawing commands
 								// Stay in WAITING. Next loop will process the drawing commands.
-								stateStartTime = get_absolute_time(); // Reset timer for this check cycle
+								stateStartPoll = getPollCount(); // Reset timer for this check cycle
 							}
 							// Check if exactly 3 initials are entered *and* drawing is complete
 							else if (initialsEnteredCount == 3) {
@@ -549,23 +552,23 @@ namespace Snake {
 								selectColor(1);
 								selectPalette(5); selectPalette(4); selectPalette(3); selectPalette(6);
 								// Stay in WAITING to process navigateToPosition
-								stateStartTime = get_absolute_time();
+								stateStartPoll = getPollCount();
 							}
 							// Check if finalization step (cursor move) is complete
 							else if (initialsEnteredCount == 4) {
 								// The navigateToPosition queued above must have just finished. Time to exit.
 								snakeState = SnakeState::EXIT_SNAKE;
-								stateStartTime = get_absolute_time();
+								stateStartPoll = getPollCount();
 							}
 							// Check if it wasn't a high score case and drawing/cursor move is finished
 							else if (!isExpectingInitials() && initialsEnteredCount == 0) {
 								// This handles the non-high-score case where navigateToPosition finished.
 								snakeState = SnakeState::EXIT_SNAKE;
-								stateStartTime = get_absolute_time();
+								stateStartPoll = getPollCount();
 							}
 							// Else: Waiting for more initials to be buffered, or for drawing actions to complete. Stay in WAITING.
 							else {
-								stateStartTime = get_absolute_time();
+								stateStartPoll = getPollCount();
 							}
 
 
@@ -621,11 +624,11 @@ namespace Snake {
 
 							gameOverSequenceStarted = true; // Mark drawing sequence as started
 							// Stay in WAITING to process the drawing queue
-							stateStartTime = get_absolute_time(); // Reset timer for the drawing actions
+							stateStartPoll = getPollCount(); // Reset timer for the drawing actions
 						}
 					} 
 					else {
-						stateStartTime = get_absolute_time();
+						stateStartPoll = getPollCount();
 					}
 				} 
 				break;
@@ -637,7 +640,7 @@ namespace Snake {
 
 			case SnakeState::EXIT_SNAKE:
 				// Check timer using standard duration before actually exiting
-				if (elapsed_us >= hold_duration_us) {
+				if (elapsedPolls >= timing.holdPolls) {
 					inSnakeMode = false;
 					gameActive = false;
 					// Clear queues and state
@@ -647,14 +650,14 @@ namespace Snake {
 					enteredInitials[0] = '\0';
 					gameOverSequenceStarted = false; // Reset for next game over
 					keyBuffer.clear(); // Clear main typing buffer
-					stateStartTime = 0; // Reset timer for next entry into snake mode
+					stateTimerStarted = false; // Reset timer for next entry into snake mode
 				}
 				break;
 
 			default:
 				// Should not happen, reset to waiting
 				snakeState = SnakeState::WAITING;
-				stateStartTime = get_absolute_time();
+				stateStartPoll = getPollCount();
 				break;
 		}
 	} 
@@ -106,7 +106,7 @@ namespace Snake {
 	// Public functions
 	bool isInSnakeMode();
 	void enterSnakeMode(uint8_t initialPalette, uint8_t initialColor, int x, int y);
-	void processSnake(GCReport& report, uint64_t hold_duration_us);
+	void processSnake(GCReport& report, const InputTiming& timing);
 	void updateSnakeDirection(); // New function to capture direction changes at any time
 	bool isExpectingInitials();
 
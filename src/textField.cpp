@@ -0,0 +1,43 @@
+#include "textField.hpp"
+
+static GlyphId glyphs[TextField::MAX_LENGTH];
+static size_t count = 0;
+// Unknown until a keyboard is seen opening empty, the game may already have one open with text in it
+static bool known = false;
+
+namespace TextField {
+
+	void commit(GlyphId glyph) {
+		if (count == MAX_LENGTH) {
+			known = false;
+			return;
+		}
+		glyphs[count++] = glyph;
+	}
+
+	void erase() {
+		// Deleting from an empty field does nothing, deleting from an unknown one keeps it unknown
+		if (count > 0) count--;
+	}
+
+	void forget() {
+		known = false;
+	}
+
+	void clear() {
+		count = 0;
+		known = true;
+	}
+
+	bool isKnown() {
+		return known;
+	}
+
+	size_t length() {
+		return count;
+	}
+
+	GlyphId at(size_t index) {
+		return index < count ? glyphs[index] : 0;
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "types.hpp"
+
+// What has been typed into the in-game text field so far. Fed by the typing engine and by
+// A and B pressed in passthrough; the content is only trusted while nothing could have
+// changed it unseen, e.g. held B auto repeating in the game.
+namespace TextField {
+	static const size_t MAX_LENGTH = 256;
+
+	// An A press typed this glyph
+	void commit(GlyphId glyph);
+
+	// A B press deleted the last glyph
+	void erase();
+
+	// Something changed the field that cannot be followed
+	void forget();
+
+	// The field was emptied, e.g. Start closed the keyboard and the next one starts out empty
+	void clear();
+
+	// Whether length() and at() match the game
+	bool isKnown();
+	size_t length();
+	GlyphId at(size_t index);
+}
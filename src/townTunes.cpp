@@ -2,15 +2,14 @@
 #include "simulatedController.hpp"
 #include "types.hpp"
 #include "gcReport.hpp"
+#include "joybus.hpp"
+#include "glyphIndex.hpp"
 #include <cstdio>
 #include <cstring>
 #include <pico/stdlib.h>
 
-bool isFrogCharacter(const Utf8Char& c) {
-	// Compare with UTF-8 bytes for 🐸
-	static const uint8_t frogChar[] = {0xF0, 0x9F, 0x90, 0xB8};
-	if (c.length != 4) return false;
-	return memcmp(c.bytes, frogChar, 4) == 0;
+bool isFrogCharacter(GlyphId c) {
+	return c == GlyphIndex::FROG;
 }
 
 // External declarations
@@ -19,6 +18,9 @@ extern DeviceState device2;
 extern KeyBuffer keyBuffer;
 extern bool tracker_is_active(KeyTracker* tracker, uint8_t keycode);
 
+// How long a tune takes to play through once it is set
+static const uint32_t TUNE_PLAYTIME_MS = 4200;
+
 // Town tune mode variables
 static int currentTuneIndex = 0;
 static int currentNotePosition = 0;
@@ -84,15 +86,15 @@ namespace TownTunes {
     }
 
     void processTownTune(GCReport& report, bool xJustPressed, bool leftJustPressed, bool rightJustPressed,
-                        bool startPressed, int64_t hold_duration_us) {
-        static absolute_time_t stateStartTime = get_absolute_time();
-        absolute_time_t currentTime = get_absolute_time();
-        int64_t elapsed_us = absolute_time_diff_us(stateStartTime, currentTime);
+                        bool startPressed, const InputTiming& timing) {
+        static uint32_t stateStartPoll = getPollCount();
+        uint32_t currentPoll = getPollCount();
+        uint32_t elapsedPolls = currentPoll - stateStartPoll;
         
-        // Standard duration and twice the standard duration for longer waits
-        const int64_t standard_duration = hold_duration_us;
-        const int64_t longer_duration = 14 * standard_duration;
-        const int64_t tune_playtime = 4200000;
+        // Menu transitions run on game frames, so wait in polls too. The tune plays for a fixed
+        // time, not a number of frames, so on 50Hz consoles it still gets its 4.2s
+        const uint32_t longer_duration = timing.menuPolls;
+        const uint32_t tune_playtime = TUNE_PLAYTIME_MS * timing.pollsPerSecond / 1000;
         
         // Start with neutral state
         report = defaultGcReport;
@@ -108,19 +110,32 @@ namespace TownTunes {
             case TuneState::EXIT_NEUTRAL1:
             case TuneState::EXIT_NEUTRAL2:
             case TuneState::EXIT_NEUTRAL3:
-                stateWillChange = elapsed_us >= longer_duration;
+                stateWillChange = elapsedPolls >= longer_duration;
                 break;
             case TuneState::PLAYING:
-                stateWillChange = elapsed_us >= tune_playtime;
+                stateWillChange = elapsedPolls >= tune_playtime;
+                break;
+            case TuneState::SETTING_NOTE:
+                stateWillChange = elapsedPolls >= (pressingUp ? timing.holdPolls : timing.releasePolls);
+                break;
+            case TuneState::INIT_START:
+            case TuneState::INIT_B:
+            case TuneState::INIT_Y:
+            case TuneState::INIT_A:
+            case TuneState::X_BUTTON:
+            case TuneState::EXIT_START:
+            case TuneState::EXIT_A1:
+            case TuneState::EXIT_A2:
+                stateWillChange = elapsedPolls >= timing.buttonPolls;
                 break;
             default:
-                stateWillChange = elapsed_us >= standard_duration;
+                stateWillChange = elapsedPolls >= timing.holdPolls;
                 break;
         }
         
         if (!tuneSequenceStarted) {
             tuneSequenceStarted = true;
-            stateStartTime = currentTime;
+            stateStartPoll = currentPoll;
             return;
         }
         
@@ -130,7 +145,7 @@ namespace TownTunes {
                 report.start = 1;
                 if (stateWillChange) {
                     tuneState = TuneState::INIT_NEUTRAL;
-                    stateStartTime = currentTime;
+                    stateStartPoll = currentPoll;
                 }
                 break;
                 
@@ -139,7 +154,7 @@ namespace TownTunes {
                 report.start = 1;
                 if (stateWillChange) {
                     tuneState = TuneState::EXIT_NEUTRAL1;
-                    stateStartTime = currentTime;
+                    stateStartPoll = currentPoll;
                 }
                 break;
                 
@@ -147,7 +162,7 @@ namespace TownTunes {
                 // Neutral state with longer duration
                 if (stateWillChange) {
                     tuneState = TuneState::INIT_B;
-                    stateStartTime = currentTime;
+                    stateStartPoll = currentPoll;
                 }
                 break;
                 
@@ -155,7 +170,7 @@ namespace TownTunes {
                 report.b = 1;
                 if (stateWillChange) {
                     tuneState = TuneState::INIT_NEUTRAL2;
-                    stateStartTime = currentTime;
+                    stateStartPoll = currentPoll;
                 }
                 break;
                 
@@ -163,7 +178,7 @@ namespace TownTunes {
                 // Neutral state with double duration
                 if (stateWillChange) {
                     tuneState = TuneState::INIT_Y;
-                    stateStartTime = currentTime;
+                    stateStartPoll = currentPoll;
                 }
                 break;
                 
@@ -171,7 +186,7 @@ namespace TownTunes {
                 report.y = 1;
                 if (stateWillChange) {
                     tuneState = TuneState::INIT_NEUTRAL3;
-                    stateStartTime = currentTime;
+                    stateStartPoll = currentPoll;
                 }
                 break;
                 
@@ -179,7 +194,7 @@ namespace TownTunes {
                 // Neutral state with double duration
                 if (stateWillChange) {
                     tuneState = TuneState::INIT_A;
-                    stateStartTime = currentTime;
+                    stateStartPoll = currentPoll;
                 }
                 break;
                 
@@ -187,7 +202,7 @@ namespace TownTunes {
                 report.a = 1;
                 if (stateWillChange) {
                     tuneState = TuneState::INIT_NEUTRAL4;
-                    stateStartTime = currentTime;
+                    stateStartPoll = currentPoll;
                 }
                 break;
                 
@@ -195,7 +210,7 @@ namespace TownTunes {
                 // Neutral state with double duration
                 if (stateWillChange) {
                     tuneState = TuneState::SETTING_NOTE;
-                    stateStartTime = currentTime;
+                    stateStartPoll = currentPoll;
                 }
                 break;
                 
@@ -210,20 +225,20 @@ namespace TownTunes {
                     if (stateWillChange) {
                         upPressCount++;
                         pressingUp = false;
-                        stateStartTime = currentTime;
+                        stateStartPoll = currentPoll;
                     }
                 } else if (!pressingUp && upPressCount < targetNoteIndex) {
                     // Return to neutral between presses
                     if (stateWillChange) {
                         pressingUp = true;
-                        stateStartTime = currentTime;
+                        stateStartPoll = currentPoll;
                     }
                 } else {
                     // We've reached the target note, move to the next state
                     if (stateWillChange) {
                         upPressCount = 0;
                         tuneState = TuneState::MOVING_RIGHT;
-                        stateStartTime = currentTime;
+                        stateStartPoll = currentPoll;
                     }
                 }
                 break;
@@ -235,7 +250,7 @@ namespace TownTunes {
                     // Go to separate X button state
                     if (stateWillChange) {
                         tuneState = TuneState::X_BUTTON;
-                        stateStartTime = currentTime;
+                        stateStartPoll = currentPoll;
                     }
                 } else {
                     // Move right to next note position
@@ -243,7 +258,7 @@ namespace TownTunes {
                     if (stateWillChange) {
                         currentNotePosition++;
                         tuneState = TuneState::SETTING_NOTE;
-                        stateStartTime = currentTime;
+                        stateStartPoll = currentPoll;
                     }
                 }
                 break;
@@ -253,7 +268,7 @@ namespace TownTunes {
                 report.x = 1;
                 if (stateWillChange) {
                     tuneState = TuneState::PLAYING;
-                    stateStartTime = currentTime;
+                    stateStartPoll = currentPoll;
                 }
                 break;
                 
@@ -264,7 +279,7 @@ namespace TownTunes {
                     tuneSequenceStarted = false;
                     tuneState = TuneState::WAITING;
                     tuneCompleted = true;  // Mark tune as completed
-                    stateStartTime = currentTime;
+                    stateStartPoll = currentPoll;
                 }
                 break;
                 
@@ -277,7 +292,7 @@ namespace TownTunes {
                 // Neutral state with longer duration after start press
                 if (stateWillChange) {
                     tuneState = TuneState::EXIT_A1;
-                    stateStartTime = currentTime;
+                    stateStartPoll = currentPoll;
                 }
                 break;
                 
@@ -286,7 +301,7 @@ namespace TownTunes {
                 report.a = 1;
                 if (stateWillChange) {
                     tuneState = TuneState::EXIT_NEUTRAL2;
-                    stateStartTime = currentTime;
+                    stateStartPoll = currentPoll;
                 }
                 break;
                 
@@ -294,7 +309,7 @@ namespace TownTunes {
                 // Neutral state with longer duration between A presses
                 if (stateWillChange) {
                     tuneState = TuneState::EXIT_A2;
-                    stateStartTime = currentTime;
+                    stateStartPoll = currentPoll;
                 }
                 break;
                 
@@ -303,7 +318,7 @@ namespace TownTunes {
                 report.a = 1;
                 if (stateWillChange) {
                     tuneState = TuneState::EXIT_NEUTRAL3;
-                    stateStartTime = currentTime;
+                    stateStartPoll = currentPoll;
                 }
                 break;
                 
@@ -311,7 +326,7 @@ namespace TownTunes {
                 // Final neutral state
                 if (stateWillChange) {
                     tuneState = TuneState::EXIT_COMPLETE;
-                    stateStartTime = currentTime;
+                    stateStartPoll = currentPoll;
                 }
                 break;
                 
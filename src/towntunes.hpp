@@ -8,7 +8,7 @@
 #include "types.hpp"
 
 // Function to check if a UTF-8 character is the frog emoji
-bool isFrogCharacter(const Utf8Char& c);
+bool isFrogCharacter(GlyphId c);
 
 namespace TownTunes {
 	// Town tune data structure - each string represents a 16-note melody
@@ -66,7 +66,7 @@ namespace TownTunes {
 
 	// Process town tune state machine
 	void processTownTune(GCReport& report, bool xJustPressed, bool leftJustPressed, 
-					bool rightJustPressed, bool startPressed, int64_t hold_duration_us);
+					bool rightJustPressed, bool startPressed, const InputTiming& timing);
 
 	// Exit town tune mode
 	void exitTownTuneMode();
@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include "hardware/pio.h"
 #include <vector>
+#include <atomic>
 
 // Pin definitions
 #define GPIO_OUTPUT_PIN 2
@@ -22,6 +23,10 @@ struct Utf8Char {
 	uint8_t length;
 };
 
+// Index of a glyph in GlyphIndex::table. Glyphs travel through the device as ids and are
+// only converted from and to UTF-8 where text comes in or goes out.
+typedef uint8_t GlyphId;
+
 struct KeyTracker {
 	uint8_t keycodes[256];
 };
@@ -55,6 +60,8 @@ struct DeviceState {
 	KeyTracker key_tracker;
 	uint8_t last_state[8];
 	absolute_time_t next_retry_time;
+	absolute_time_t settle_time;
+	bool settling;
 	bool backspace_held;
 	
 	// Calibration offsets
@@ -107,27 +114,53 @@ struct Utf8String {
 	}
 };
 
+// Single producer, single consumer ring of typed glyphs. Positions run freely and are masked into
+// the ring, the producer publishes a glyph with a release store of writePos and the consumer frees
+// a slot with a release store of readPos, so either side may live on the other core.
 struct KeyBuffer {
 	static const size_t BUFFER_SIZE = 256;
-	Utf8Char buffer[BUFFER_SIZE];
-	size_t readPos = 0;
-	size_t writePos = 0;
-	size_t count = 0;
+	static_assert((BUFFER_SIZE & (BUFFER_SIZE - 1)) == 0, "BUFFER_SIZE must be a power of two");
+	static const size_t MASK = BUFFER_SIZE - 1;
+
+	GlyphId buffer[BUFFER_SIZE];
+	std::atomic<size_t> readPos{0};
+	std::atomic<size_t> writePos{0};
+	std::atomic<size_t> highWater{0};   // Most glyphs ever waiting at once
+	std::atomic<uint32_t> dropped{0};   // Glyphs lost to a full buffer
+
+	// Producer side. push() counts a full buffer as a dropped glyph, for producers that cannot
+	// hold on to it. tryPush() does not, the caller keeps the glyph and retries once freeSlots() allows.
+	bool push(GlyphId c);
+	bool tryPush(GlyphId c);
+	size_t freeSlots() const;
+	// Takes back the newest glyph, unless the consumer got to it first
+	bool retract(GlyphId& c);
 
-	bool push(const Utf8Char& c);
-	bool pop(Utf8Char& c);
+	// Consumer side
+	bool pop(GlyphId& c);
+	bool peek(size_t offset, GlyphId& c) const;
 	bool isEmpty() const;
+	size_t size() const;
 	void clear() {
-		readPos = 0;
-		writePos = 0;
-		count = 0;
+		readPos.store(writePos.load(std::memory_order_acquire), std::memory_order_release);
 	}
 };
 
+// Input timing counted in console polls, so presses line up with game frames on 50Hz and 60Hz consoles alike
+struct InputTiming {
+	uint32_t pollsPerFrame; // Status polls the console makes per game frame
+	uint32_t holdPolls;     // Polls a stick tap stays pressed
+	uint32_t buttonPolls;   // Polls a button stays pressed
+	uint32_t releasePolls;  // Neutral polls between two inputs
+	uint32_t menuPolls;     // Polls to wait for a menu to open or close
+	uint32_t settlePolls;   // Polls to wait for a design frame to finish loading
+	uint32_t pollsPerSecond; // For waits that last a fixed time rather than a number of frames
+};
+
 struct SimulatedState {
 	uint8_t xStick;
 	uint8_t yStick;
-	uint32_t hold_duration_us;
+	InputTiming timing;
 	bool keyboard_calibrated;
 };
 
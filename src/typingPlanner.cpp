@@ -0,0 +1,74 @@
+#include "typingPlanner.hpp"
+#include "glyphIndex.hpp"
+#include <climits>
+
+namespace TypingPlanner {
+
+	Candidates findCandidates(GlyphId glyph) {
+		Candidates candidates = {};
+		const GlyphIndex::Glyph* entry = GlyphIndex::find(glyph);
+		if (entry == nullptr) return candidates;
+		for (uint8_t i = 0; i < entry->count; i++) {
+			candidates.positions[candidates.count++] = GlyphIndex::cellPos(entry->cells[i]);
+		}
+		return candidates;
+	}
+
+	int layerSwitchCost(uint8_t from, uint8_t to) {
+		return GlyphIndex::layerSwitchCosts[from & 3][to & 3];
+	}
+
+	int inputCost(const VirtualKeyboardPos& from, const VirtualKeyboardPos& to) {
+		return GlyphIndex::moveCost(GlyphIndex::cellIndex(from), GlyphIndex::cellIndex(to)) + 1;
+	}
+
+	bool planNext(const VirtualKeyboardPos& from, GlyphId next, const KeyBuffer& pending,
+				  VirtualKeyboardPos& target) {
+		const GlyphIndex::Glyph* start = GlyphIndex::find(next);
+		if (start == nullptr) return false;
+		const GlyphIndex::Glyph* current = start;
+
+		// cost[k]: fewest inputs to type the window so far, ending on cell k of the latest glyph
+		// first[k]: which cell of `next` that cheapest path started with
+		int cost[MAX_POSITIONS];
+		uint8_t first[MAX_POSITIONS];
+		uint8_t fromCell = GlyphIndex::cellIndex(from);
+		for (uint8_t k = 0; k < current->count; k++) {
+			cost[k] = GlyphIndex::moveCost(fromCell, current->cells[k]) + 1;
+			first[k] = k;
+		}
+
+		for (size_t i = 0; i + 1 < WINDOW; i++) {
+			GlyphId glyph;
+			if (!pending.peek(i, glyph)) break;
+			const GlyphIndex::Glyph* following = GlyphIndex::find(glyph);
+			// Mode switching glyphs and anything not on the keyboard end the window
+			if (following == nullptr) break;
+
+			int nextCost[MAX_POSITIONS];
+			uint8_t nextFirst[MAX_POSITIONS];
+			for (uint8_t k = 0; k < following->count; k++) {
+				nextCost[k] = INT_MAX;
+				for (uint8_t j = 0; j < current->count; j++) {
+					int total = cost[j] + GlyphIndex::moveCost(current->cells[j], following->cells[k]) + 1;
+					if (total < nextCost[k]) {
+						nextCost[k] = total;
+						nextFirst[k] = first[j];
+					}
+				}
+			}
+			for (uint8_t k = 0; k < following->count; k++) {
+				cost[k] = nextCost[k];
+				first[k] = nextFirst[k];
+			}
+			current = following;
+		}
+
+		uint8_t best = 0;
+		for (uint8_t k = 1; k < current->count; k++) {
+			if (cost[k] < cost[best]) best = k;
+		}
+		target = GlyphIndex::cellPos(start->cells[first[best]]);
+		return true;
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+#include "types.hpp"
+#include "glyphIndex.hpp"
+
+namespace TypingPlanner {
+	// Glyphs of the pending buffer the planner looks ahead at, including the one being typed
+	static const size_t WINDOW = 24;
+
+	static const uint8_t MAX_POSITIONS = GlyphIndex::MAX_CELLS;
+
+	struct Candidates {
+		VirtualKeyboardPos positions[MAX_POSITIONS];
+		uint8_t count;
+	};
+
+	// Every cell the glyph can be typed from, on any layer, without allocating
+	Candidates findCandidates(GlyphId glyph);
+
+	// L/Y presses needed to get from one layer to another (L toggles 0/1, Y cycles 0/1 -> 2 -> 3 -> 0)
+	int layerSwitchCost(uint8_t from, uint8_t to);
+
+	// Inputs needed to go from one cell to another and press A there
+	int inputCost(const VirtualKeyboardPos& from, const VirtualKeyboardPos& to);
+
+	/**
+	 * Picks the cell to type `next` from so that it and the glyphs still pending
+	 * in the buffer take the fewest inputs in total. Returns false if `next` is
+	 * not on the keyboard.
+	 */
+	bool planNext(const VirtualKeyboardPos& from, GlyphId next, const KeyBuffer& pending,
+				  VirtualKeyboardPos& target);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+// The in-game keyboard, one 4x10 grid per layer (L toggles 0/1, Y cycles 0/1 -> 2 -> 3 -> 0)
+inline constexpr const char* virtualKeyboard[4][4][10] = {
+	{ // letters - lowercase qwerty
+		{"!", "?", "\"", "-", "~", "–", "'", ";", ":", "🗝️"},
+		{"q", "w", "e", "r", "t", "y", "u", "i", "o", "p"},
+		{"a", "s", "d", "f", "g", "h", "j", "k", "l", "↵"},
+		{"z", "x", "c", "v", "b", "n", "m", ",", ".", "␣"}
+	},
+	{ // letters - uppercase qwerty
+		{"1", "2", "3", "4", "5", "6", "7", "8", "9", "0"},
+		{"Q", "W", "E", "R", "T", "Y", "U", "I", "O", "P"},
+		{"A", "S", "D", "F", "G", "H", "J", "K", "L", "↵"},
+		{"Z", "X", "C", "V", "B", "N", "M", ",", ".", "␣"}
+	},
+	{ // punctuation
+		{"#", "?", "\"", "-", "~", "–", "·", ";", ":", "Æ"},
+		{"%", "&", "@", "_", "‾", "/", "╏", "×", "÷", "="},
+		{"(", ")", "<", ">", "»", "«", "≽", "≼", "+", "↵"},
+		{"β", "þ", "ð", "§", "ǁ", "μ", "¬", ",", ".", "␣"}
+	},
+	{ // icons
+		{"♥", "★", "♪", "💧", "💢", "🌺", "🐾", "♂", "♀", "∞"},
+		{"⭕", "❌", "🔳", "🔺", "💀", "😱", "😁", "😞", "😡", "😀"},
+		{"☀", "☁", "☂", "⛄", "🌀", "⚡", "🔨", "🎀", "✉", "↵"},
+		{"🐿️", "🐱", "🐰", "🐙", "🐮", "🐷", "💰", "🐟", "🪲", "␣"}
+	}
+};
@@ -0,0 +1,42 @@
+#!/bin/bash
+set -e
+
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+
+# Options go ahead of the file, e.g. --replace or --width=24
+STREAM_ARGS=()
+while [[ "$1" == --* ]]; do
+	STREAM_ARGS+=("$1")
+	shift
+done
+
+if [ $# -lt 1 ]; then
+	echo "Usage: $0 [--replace] [--width=N [--lines=N]] <text_file|-> [serial_port]"
+	echo ""
+	echo "Types the text on the in-game keyboard. Use - to read from stdin."
+	echo "With --replace, the text replaces what is already in the text field, retyping only what changed."
+	echo "With --width, the text is word wrapped with typed line breaks; --lines leaves out what does not fit."
+	exit 1
+fi
+
+INPUT_FILE="$1"
+SERIAL_PORT="$2"
+
+# Same port detection as monitor.sh
+if [ -z "$SERIAL_PORT" ]; then
+	case "$(uname)" in
+		"Darwin")
+			SERIAL_PORT=$(ls /dev/tty.usbmodem* 2>/dev/null | head -n 1)
+			;;
+		"Linux")
+			SERIAL_PORT=$(ls /dev/ttyACM* 2>/dev/null | head -n 1)
+			;;
+	esac
+fi
+
+if [ -z "$SERIAL_PORT" ]; then
+	echo "No suitable serial port found. Is your Pico connected?"
+	exit 1
+fi
+
+python3 "$SCRIPT_DIR/text_tools/stream_text.py" "${STREAM_ARGS[@]}" "$SERIAL_PORT" "$INPUT_FILE"
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+import argparse
+import os
+import re
+from collections import Counter, defaultdict
+
+# Successors kept per glyph, must match Predictor::PRIOR_SUCCESSORS
+SUCCESSORS = 4
+
+
+def keyboard_glyphs(project_dir):
+	with open(os.path.join(project_dir, 'src', 'virtualKeyboard.hpp'), encoding='utf-8') as f:
+		source = f.read()
+	table = source[source.index('= {'):]
+	return set(bytes(g, 'utf-8').decode('unicode_escape').encode('latin-1').decode('utf-8') for g in re.findall(r'"((?:[^"\\]|\\.)*)"', table))
+
+
+def to_glyphs(text, glyphs):
+	"""Hard wrapped lines are joined, blank lines become a typed line break."""
+	text = text.replace('\r\n', '\n')
+	paragraphs = re.split(r'\n\s*\n', text)
+	out = []
+	for paragraph in paragraphs:
+		for c in ' '.join(paragraph.split()):
+			if c == ' ':
+				out.append('␣')
+			elif c in glyphs:
+				out.append(c)
+			else:
+				# Anything the game cannot type breaks the chain
+				out.append(None)
+		out.append('↵')
+	return out
+
+
+def escape(glyph):
+	return glyph.replace('\\', '\\\\').replace('"', '\\"')
+
+
+def main():
+	parser = argparse.ArgumentParser(description='Generate the typing predictor\'s bigram table (src/bigrams.hpp) from sample text.')
+	parser.add_argument('inputs', nargs='*', help='UTF-8 text files to count bigrams in (default: text_tools/corpus/*.txt)')
+	parser.add_argument('--project-dir', help='Path to the project directory',
+						default=os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+	args = parser.parse_args()
+	if not args.inputs:
+		# Letters, diary entries and bulletin board notes, the kind of text players type in the game
+		corpus_dir = os.path.join(args.project_dir, 'text_tools', 'corpus')
+		args.inputs = sorted(os.path.join(corpus_dir, name) for name in os.listdir(corpus_dir) if name.endswith('.txt'))
+
+	glyphs = keyboard_glyphs(args.project_dir)
+	counts = defaultdict(Counter)
+	for path in args.inputs:
+		with open(path, encoding='utf-8') as f:
+			sequence = to_glyphs(f.read(), glyphs)
+		for a, b in zip(sequence, sequence[1:]):
+			if a is not None and b is not None:
+				counts[a][b] += 1
+
+	rows = []
+	for glyph in sorted(counts, key=lambda g: -sum(counts[g].values())):
+		total = sum(counts[glyph].values())
+		successors = []
+		for successor, count in counts[glyph].most_common(SUCCESSORS):
+			# Weights are out of 255 of everything that followed, the remainder is spread over the keyboard
+			weight = round(255 * count / total)
+			if weight > 0:
+				successors.append(f'{{"{escape(successor)}", {weight}}}')
+		if successors:
+			rows.append(f'\t\t{{"{escape(glyph)}", {{{", ".join(successors)}}}}},')
+
+	sources = ', '.join(os.path.relpath(os.path.abspath(p), args.project_dir) for p in args.inputs)
+	output = os.path.join(args.project_dir, 'src', 'bigrams.hpp')
+	with open(output, 'w', encoding='utf-8') as f:
+		f.write('#pragma once\n\n#include <stdint.h>\n\n')
+		f.write(f'// Generated by text_tools/build_bigrams.py from {sources}, do not edit by hand\n')
+		f.write('namespace Bigrams {\n')
+		f.write('\tstruct Successor {\n\t\tconst char* glyph;\n\t\tuint8_t weight;\n\t};\n\n')
+		f.write('\tstruct Row {\n\t\tconst char* glyph;\n\t\tSuccessor next[' + str(SUCCESSORS) + '];\n\t};\n\n')
+		f.write('\tinline constexpr Row rows[] = {\n')
+		f.write('\n'.join(rows))
+		f.write('\n\t};\n}\n')
+	print(f"Wrote {len(rows)} glyphs to {output}")
+
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+// Only for DeviceState in types.hpp, nothing on the host touches a PIO
+typedef struct pio_hw pio_hw_t;
+typedef pio_hw_t* PIO;
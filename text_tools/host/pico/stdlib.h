@@ -0,0 +1,15 @@
+#pragma once
+
+// The parts of the Pico SDK serial input and the headers it includes use, for building it on the host
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+#define PICO_ERROR_TIMEOUT (-1)
+
+// Reads stdin in place of USB CDC, PICO_ERROR_TIMEOUT when nothing is waiting
+int getchar_timeout_us(uint32_t timeout_us);
+uint32_t time_us_32();
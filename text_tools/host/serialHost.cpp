@@ -0,0 +1,130 @@
+// src/serialInput.cpp built for the host, for text_tools/test_serial_pty.py. Serial input reads stdin
+// and prints to stdout as it does over USB CDC on the Pico, and a stand-in for the typing engine
+// drains the key buffer into the text field a few glyphs per poll. Once stdin is closed whatever is
+// left gets typed, and stderr gets the number of glyphs erased followed by everything the field
+// ended up with, a glyph per line. TextField only follows its first MAX_LENGTH glyphs, so the
+// whole text is kept here as well.
+#include "serialInput.hpp"
+#include "textField.hpp"
+#include "glyphIndex.hpp"
+#include "display.hpp"
+#include "keymap.hpp"
+#include "predictor.hpp"
+#include "nookCodes.hpp"
+#include "simulatedController.hpp"
+#include "townTunes.hpp"
+#include "design.hpp"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+KeyBuffer keyBuffer;
+
+// Glyphs typed per poll, fewer than the host sends so the key buffer fills up
+static const uint32_t TYPED_PER_POLL = 3;
+
+// How long the main loop waits for input between polls
+static const int POLL_MS = 1;
+
+static bool inputClosed = false;
+static uint32_t pendingErases = 0;
+static uint32_t erased = 0;
+static std::vector<GlyphId> typed;
+
+int getchar_timeout_us(uint32_t) {
+	uint8_t byte;
+	ssize_t count = read(STDIN_FILENO, &byte, 1);
+	if (count == 1) return byte;
+	if (count == 0 || errno != EAGAIN) inputClosed = true;
+	return PICO_ERROR_TIMEOUT;
+}
+
+uint32_t time_us_32() {
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)(now.tv_sec * 1000000ull + now.tv_nsec / 1000);
+}
+
+bool isTypingIdle() {
+	return pendingErases == 0 && keyBuffer.isEmpty();
+}
+
+void eraseTypedGlyphs(uint32_t count) {
+	pendingErases += count;
+}
+
+// Erasing comes first, like the B presses the engine makes before typing on
+static void typeSome() {
+	for (uint32_t i = 0; i < TYPED_PER_POLL; i++) {
+		if (pendingErases > 0) {
+			pendingErases--;
+			erased++;
+			TextField::erase();
+			if (!typed.empty()) typed.pop_back();
+			continue;
+		}
+		GlyphId glyph;
+		if (!keyBuffer.pop(glyph)) return;
+		TextField::commit(glyph);
+		typed.push_back(glyph);
+	}
+}
+
+// Whatever else serial input reaches for, none of it takes part in streaming text
+void render_timing_info() {}
+void select_keymap(uint8_t) {}
+uint8_t get_keymap_index() { return 0; }
+const char* get_keymap_name() { return "host"; }
+
+namespace Predictor {
+	void setEnabled(bool) {}
+	bool isEnabled() { return false; }
+}
+
+namespace Design {
+	void nextRecalibrationPolicy() {}
+	const char* getRecalibrationPolicyName() { return "host"; }
+
+	// design.hpp defines a provider in every file that includes it
+	uint8_t StreamingFrameProvider::getPaletteId(size_t) const { return 0; }
+	const FrameData& StreamingFrameProvider::getFrame(size_t) { return currentFrame; }
+}
+
+namespace NookCodes {
+	bool isInNookCodeMode() { return false; }
+}
+
+namespace TownTunes {
+	bool isInTownTuneMode() { return false; }
+}
+
+int main() {
+	setvbuf(stdout, nullptr, _IONBF, 0);
+	fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+
+	// As if the keyboard had just been opened on an empty field
+	TextField::clear();
+
+	while (!inputClosed) {
+		typeSome();
+		SerialInput::poll();
+		pollfd input = {STDIN_FILENO, POLLIN, 0};
+		poll(&input, 1, POLL_MS);
+	}
+	// Long enough for serial input to give up waiting on the last glyph
+	uint32_t closedAt = time_us_32();
+	while (!isTypingIdle() || time_us_32() - closedAt < 2 * SerialInput::GLYPH_WAIT_US) {
+		typeSome();
+		SerialInput::poll();
+	}
+
+	fprintf(stderr, "%u\n", (unsigned)erased);
+	for (GlyphId glyph : typed) {
+		fprintf(stderr, "%s\n", GlyphIndex::toUtf8(glyph));
+	}
+	return 0;
+}
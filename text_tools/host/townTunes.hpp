@@ -0,0 +1,4 @@
+#pragma once
+
+// Sources include townTunes.hpp, the header is src/towntunes.hpp, which only a case-insensitive file system finds
+#include "towntunes.hpp"
@@ -0,0 +1,301 @@
+#!/usr/bin/env python3
+import argparse
+import os
+import re
+import select
+import sys
+import termios
+import time
+import tty
+
+# Control bytes of the serial text protocol (see src/serialInput.hpp)
+END_OF_TEXT = b'\x04'
+CREDIT_REQUEST = b'\x05'
+CREDIT_GRANT = 0x06
+REJECTED = 0x15
+REPLACE_FIELD = b'\x12'
+
+# Lines the device prints about a replacement
+REPLACE_NOTES = (b'Replaced text field', b'Text field unknown')
+
+# Ask again if a request went unanswered or granted nothing for this long
+REQUEST_RETRY_S = 0.25
+
+# Glyphs written per write() call
+CHUNK = 64
+
+# Must match GlyphIndex::layerSwitchCosts
+LAYER_SWITCH_COSTS = [
+	[0, 1, 1, 2],
+	[1, 0, 1, 2],
+	[2, 3, 0, 1],
+	[1, 2, 2, 0],
+]
+KEYBOARD_COLS = 10
+KEYBOARD_ROWS = 4
+
+
+def load_text(path):
+	if path == '-':
+		data = sys.stdin.buffer.read()
+	else:
+		with open(path, 'rb') as f:
+			data = f.read()
+	text = data.decode('utf-8', errors='replace').replace('\r\n', '\n')
+
+	# Control bytes would be read as protocol commands
+	kept = [c for c in text if c == '\n' or ord(c) >= 0x20]
+	dropped = len(text) - len(kept)
+	if dropped:
+		print(f"Dropped {dropped} control characters", file=sys.stderr)
+	return to_glyphs(kept)
+
+
+def extends_glyph(code_point):
+	"""Variation selectors and combining marks belong to the code point before them, as in SerialInput."""
+	return 0xFE00 <= ord(code_point) <= 0xFE0F or 0x0300 <= ord(code_point) <= 0x036F
+
+
+def to_glyphs(code_points):
+	"""Groups code points into the glyphs the device types and grants credits for, e.g. 🗝 + U+FE0F."""
+	glyphs = []
+	for c in code_points:
+		if glyphs and extends_glyph(c):
+			glyphs[-1] += c
+		else:
+			glyphs.append(c)
+	return glyphs
+
+
+def keyboard_cells(project_dir):
+	"""Cells (layer, row, col) each glyph can be typed from, read from src/virtualKeyboard.hpp."""
+	with open(os.path.join(project_dir, 'src', 'virtualKeyboard.hpp'), encoding='utf-8') as f:
+		source = f.read()
+	table = source[source.index('= {'):]
+	cells = {}
+	for i, glyph in enumerate(re.findall(r'"((?:[^"\\]|\\.)*)"', table)):
+		glyph = bytes(glyph, 'utf-8').decode('unicode_escape').encode('latin-1').decode('utf-8')
+		layer, rest = divmod(i, KEYBOARD_ROWS * KEYBOARD_COLS)
+		cells.setdefault(glyph, []).append((layer, rest // KEYBOARD_COLS, rest % KEYBOARD_COLS))
+	cells['\n'] = cells['↵']
+	cells[' '] = cells['␣']
+	return cells
+
+
+def move_cost(a, b):
+	"""Inputs between two cells, as in GlyphIndex::costMatrix."""
+	return LAYER_SWITCH_COSTS[a[0]][b[0]] + max(abs(a[1] - b[1]), abs(a[2] - b[2]))
+
+
+def via_cost(cells, before, middle, after):
+	"""Fewest moves from `before` through `middle` to `after`; glyphs not on the keyboard cost nothing."""
+	ends_before = cells.get(before) or [None]
+	ends_after = cells.get(after) or [None]
+	best = None
+	for a in ends_before:
+		for m in cells[middle]:
+			for b in ends_after:
+				cost = (move_cost(a, m) if a else 0) + (move_cost(m, b) if b else 0)
+				if best is None or cost < best:
+					best = cost
+	return best
+
+
+def wrap_paragraph(glyphs, width, cells):
+	"""
+	Lays out one paragraph on as few lines as greedy wrapping needs, picking among those layouts the one
+	whose line breaks are cheapest to type. A break replaces a space with ↵; a word longer than a line
+	is split with an extra ↵. Returns the lines as lists of glyphs.
+	"""
+	n = len(glyphs)
+
+	def breaks_from(start):
+		"""(cost, end of line, start of next line) for every way to end the line starting at `start`."""
+		if n - start <= width:
+			return [(0, n, n)]
+		options = []
+		for end in range(start + 1, start + width + 1):
+			if glyphs[end] == ' ':
+				before = glyphs[end - 1] if end > 0 else None
+				after = glyphs[end + 1] if end + 1 < n else None
+				options.append((via_cost(cells, before, '\n', after) - via_cost(cells, before, ' ', after), end, end + 1))
+		if not options:
+			end = start + width
+			options.append((1 + via_cost(cells, glyphs[end - 1], '\n', glyphs[end]), end, end))
+		return options
+
+	# Fewest lines from each start, then the cheapest breaks that keep to it
+	lines_from = [0] * (n + 1)
+	cost_from = [0] * (n + 1)
+	choice = [None] * (n + 1)
+	for start in range(n - 1, -1, -1):
+		best = None
+		for cost, end, next_start in breaks_from(start):
+			key = (lines_from[next_start] + 1, cost + cost_from[next_start], -end)
+			if best is None or key < best[0]:
+				best = (key, end, next_start)
+		(lines_from[start], cost_from[start], _), end, next_start = best
+		choice[start] = (end, next_start)
+
+	lines = []
+	start = 0
+	while start < n:
+		end, next_start = choice[start]
+		lines.append(glyphs[start:end])
+		start = next_start
+	return lines or [[]]
+
+
+def wrap(glyphs, width, max_lines, cells):
+	"""
+	Word wraps text to `width` glyphs per line, keeping the line breaks it already has. Lines past
+	`max_lines` (0 for no limit) are left out rather than typed into a full field. Returns the glyphs
+	with line breaks as '\\n', and how many glyphs were left out.
+	"""
+	while glyphs and glyphs[-1] == '\n':
+		glyphs = glyphs[:-1]
+
+	lines = []
+	paragraph = []
+	for glyph in glyphs + ['\n']:
+		if glyph == '\n':
+			lines.extend(wrap_paragraph(paragraph, width, cells))
+			paragraph = []
+		else:
+			paragraph.append(glyph)
+
+	dropped = 0
+	if max_lines and len(lines) > max_lines:
+		dropped = sum(len(line) for line in lines[max_lines:])
+		lines = lines[:max_lines]
+
+	out = []
+	for i, line in enumerate(lines):
+		if i > 0:
+			out.append('\n')
+		out.extend(line)
+	return out, dropped
+
+
+def open_port(port):
+	fd = os.open(port, os.O_RDWR | os.O_NOCTTY)
+	tty.setraw(fd, termios.TCSANOW)
+	return fd
+
+
+class Replies:
+	"""Picks grants and rejections out of everything else the device prints."""
+
+	def __init__(self):
+		self.pending = b''
+		self.lines = b''
+		self.credits = 0
+		self.grants = 0
+		self.rejected = []
+		self.notes = []
+
+	def feed(self, data):
+		self.lines += data
+		*complete, self.lines = self.lines.split(b'\n')
+		for line in complete:
+			for note in REPLACE_NOTES:
+				start = line.find(note)
+				if start >= 0:
+					self.notes.append(line[start:].decode('utf-8', errors='replace').strip())
+
+		self.pending += data
+		while True:
+			starts = [i for i in (self.pending.find(bytes([CREDIT_GRANT])), self.pending.find(bytes([REJECTED]))) if i >= 0]
+			if not starts:
+				self.pending = b''
+				return
+			start = min(starts)
+			end = self.pending.find(b'\n', start)
+			if end < 0:
+				self.pending = self.pending[start:]
+				return
+			kind = self.pending[start]
+			body = self.pending[start + 1:end]
+			self.pending = self.pending[end + 1:]
+			if kind == CREDIT_GRANT and body.isdigit():
+				self.credits += int(body)
+				self.grants += 1
+			elif kind == REJECTED:
+				self.rejected.append(body.decode('utf-8', errors='replace'))
+
+
+def stream(fd, glyphs, quiet=False, replace=False):
+	replies = Replies()
+	sent = 0
+	last_request = 0.0
+	started = time.monotonic()
+
+	# The device holds off reading until it has typed what came before, then compares as it goes
+	if replace:
+		os.write(fd, REPLACE_FIELD)
+
+	while sent < len(glyphs):
+		now = time.monotonic()
+		if replies.credits == 0 and now - last_request >= REQUEST_RETRY_S:
+			os.write(fd, CREDIT_REQUEST)
+			last_request = now
+
+		ready, _, _ = select.select([fd], [], [], 0.01)
+		if ready:
+			replies.feed(os.read(fd, 4096))
+
+		while replies.credits > 0 and sent < len(glyphs):
+			count = min(replies.credits, CHUNK, len(glyphs) - sent)
+			os.write(fd, ''.join(glyphs[sent:sent + count]).encode('utf-8'))
+			sent += count
+			replies.credits -= count
+			if not quiet:
+				print(f"\rSent {sent}/{len(glyphs)}", end='', file=sys.stderr)
+
+	os.write(fd, END_OF_TEXT)
+
+	# Rejections for the last glyphs may still be on their way
+	deadline = time.monotonic() + REQUEST_RETRY_S
+	while time.monotonic() < deadline:
+		ready, _, _ = select.select([fd], [], [], 0.01)
+		if ready:
+			replies.feed(os.read(fd, 4096))
+
+	if not quiet:
+		print(f"\nSent {sent} glyphs in {time.monotonic() - started:.1f}s over {replies.grants} grants", file=sys.stderr)
+	for glyph in replies.rejected:
+		print(f"Not on the keyboard, skipped: {glyph!r}", file=sys.stderr)
+	for note in replies.notes:
+		print(note, file=sys.stderr)
+	return replies
+
+
+def main():
+	parser = argparse.ArgumentParser(description='Stream UTF-8 text to pico-crossing to be typed on the virtual keyboard.')
+	parser.add_argument('port', help='Serial port of the Pico, e.g. /dev/ttyACM0')
+	parser.add_argument('input', nargs='?', default='-', help='Text file to type (default: stdin)')
+	parser.add_argument('-q', '--quiet', action='store_true', default=False, help='Do not print progress')
+	parser.add_argument('-r', '--replace', action='store_true', default=False,
+						help='Replace the text already in the in-game text field, keeping what it starts with')
+	parser.add_argument('-w', '--width', type=int, default=0,
+						help='Word wrap to this many characters per line, typing the line breaks (default: no wrapping)')
+	parser.add_argument('-l', '--lines', type=int, default=0,
+						help='With --width, leave out whatever does not fit in this many lines (default: no limit)')
+	parser.add_argument('--project-dir', help='Path to the project directory',
+						default=os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+	args = parser.parse_args()
+
+	glyphs = load_text(args.input)
+	if args.width > 0:
+		glyphs, dropped = wrap(glyphs, args.width, args.lines, keyboard_cells(args.project_dir))
+		if dropped:
+			print(f"{dropped} characters do not fit in {args.lines} lines and are left out", file=sys.stderr)
+	fd = open_port(args.port)
+	try:
+		stream(fd, glyphs, args.quiet, args.replace)
+	finally:
+		os.close(fd)
+
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+Streams text through stream_text.py over a pseudo-terminal to src/serialInput.cpp built for the host.
+
+text_tools/host/serialHost.cpp runs serial input on the master end, reading and printing through
+stdio in place of USB CDC, with a stand-in typing engine that drains the key buffer into the text
+field. stream_text.py drives the slave end, as it would /dev/ttyACM0. Once the slave is closed the
+device types what is left and reports the text field, which has to hold exactly what was streamed.
+
+Usage: python3 text_tools/test_serial_pty.py (Linux, needs Python 3 and g++, or a compiler in $CXX)
+"""
+import contextlib
+import io
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import tty
+import unittest
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import stream_text
+
+PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+HOST_DIR = os.path.join(PROJECT_DIR, 'text_tools', 'host')
+SOURCES = ['src/serialInput.cpp', 'src/keybuffer.cpp', 'src/textField.cpp', 'text_tools/host/serialHost.cpp']
+
+# Must match KeyBuffer::BUFFER_SIZE
+BUFFER_SIZE = 256
+
+COMPILER = os.environ.get('CXX', 'g++')
+
+
+def typed_form(glyphs):
+	return [{'\n': '↵', ' ': '␣'}.get(g, g) for g in glyphs]
+
+
+@unittest.skipUnless(shutil.which(COMPILER), f'needs {COMPILER} to build serial input for the host')
+class SerialPtyTest(unittest.TestCase):
+
+	@classmethod
+	def setUpClass(cls):
+		cls.build_dir = tempfile.mkdtemp()
+		cls.device = os.path.join(cls.build_dir, 'serialHost')
+		subprocess.run([COMPILER, '-std=c++17', '-O1', '-I', HOST_DIR, '-I', os.path.join(PROJECT_DIR, 'src'),
+						*(os.path.join(PROJECT_DIR, source) for source in SOURCES), '-o', cls.device], check=True)
+		cls.keyboard = set(stream_text.keyboard_cells(PROJECT_DIR)) - {'\n', ' '}
+
+	@classmethod
+	def tearDownClass(cls):
+		shutil.rmtree(cls.build_dir)
+
+	def start_device(self):
+		master, slave = os.openpty()
+		tty.setraw(master)
+		tty.setraw(slave)
+		device = subprocess.Popen([self.device], stdin=master, stdout=master, stderr=subprocess.PIPE)
+		os.close(master)
+		self.addCleanup(device.kill)
+		# stream() lists rejected glyphs on stderr, the tests check them through its return value
+		quiet = contextlib.redirect_stderr(io.StringIO())
+		quiet.__enter__()
+		self.addCleanup(quiet.__exit__, None, None, None)
+		return device, slave
+
+	def stop_device(self, device, slave):
+		"""Closes the port, and returns how many glyphs the device erased and what the field holds."""
+		os.close(slave)
+		_, report = device.communicate(timeout=30)
+		erased, *field = report.decode('utf-8').splitlines()
+		return int(erased), field
+
+	def test_long_text_arrives_byte_exact(self):
+		paragraph = ("Dear Tom Nook,\nThanks for the loan! I'll pay back 39,800 Bells soon; "
+					 "maybe. Café au lait costs €5 — okay? 😀 ♪ ★\n")
+		glyphs = stream_text.to_glyphs(paragraph * 40)
+		device, slave = self.start_device()
+		replies = stream_text.stream(slave, glyphs, quiet=True)
+		_, field = self.stop_device(device, slave)
+
+		off_keyboard = [g for g in glyphs if typed_form([g])[0] not in self.keyboard]
+		expected = [g for g in typed_form(glyphs) if g in self.keyboard]
+		self.assertEqual(field, expected)
+		self.assertEqual(replies.rejected, off_keyboard)
+		self.assertEqual(set(off_keyboard), {'é', '€', '—'})
+		self.assertGreater(replies.grants, len(glyphs) // BUFFER_SIZE)
+
+	def test_variation_selector_glyphs(self):
+		# 🗝️ and 🐿️ are sent as a base code point and U+FE0F, a decomposed é as e and U+0301
+		text = "The 🗝️ is under the 🐿️'s tree.\n🗝️🗝️ café 🐿️"
+		glyphs = stream_text.to_glyphs(text)
+		device, slave = self.start_device()
+		replies = stream_text.stream(slave, glyphs, quiet=True)
+		_, field = self.stop_device(device, slave)
+
+		self.assertEqual(replies.rejected, ['é'])
+		self.assertEqual(field, [g for g in typed_form(glyphs) if g != 'é'])
+		self.assertEqual(field.count('🗝️'), 3)
+		self.assertEqual(field.count('🐿️'), 2)
+
+	def test_replace_keeps_matching_prefix(self):
+		letter = stream_text.to_glyphs("Hi Tom Nook,\nThe museum is lovely and my house is big now. See you at the fair!")
+		edited = stream_text.to_glyphs("Hi Tom Nook,\nThe museum is lovely and my house is huge now. Bye!")
+		device, slave = self.start_device()
+		stream_text.stream(slave, letter, quiet=True)
+		replies = stream_text.stream(slave, edited, quiet=True, replace=True)
+		erased, field = self.stop_device(device, slave)
+
+		kept = len("Hi Tom Nook,\nThe museum is lovely and my house is ")
+		self.assertEqual(field, typed_form(edited))
+		self.assertEqual(erased, len(letter) - kept)
+		self.assertEqual(replies.notes, ['Replaced text field: kept %d, erased %d' % (kept, len(letter) - kept)])
+
+
+if __name__ == '__main__':
+	unittest.main()